@@ -13,6 +13,9 @@ bfekete@gc.cuny.edu
 #ifndef MD_H_INCLUDED
 #define MD_H_INCLUDED
 
+#include <stdbool.h>
+#include <stddef.h>
+
 #if defined(__cplusplus)
 extern "C" {
 #endif
@@ -22,6 +25,34 @@ extern "C" {
 #define MDOptConfig_Model                       "Model"
 #define MDOptConfig_Reservoirs                  "Reservoirs"
 #define MDOptConfig_Routing                     "Routing"
+#define MDOptConfig_Profile                     "ModuleProfile"
+#define MDOptConfig_ProfileTrace                "ModuleProfileTrace"
+#define MDOptConfig_Checkpoint                  "Checkpoint"
+#define MDOptConfig_Restart                     "Restart"
+#define MDOptConfig_ParameterSweep              "ParameterSweep"
+#define MDOptConfig_SpinUp                      "SpinUp"
+#define MDOptConfig_SpinUpTolerance             "SpinUpTolerance"
+#define MDOptConfig_SpinUpUnconverged           "SpinUpUnconverged"
+#define MDOptConfig_SpinUpStatus                "SpinUpStatus"
+#define MDOptConfig_OutputWriterMemory          "OutputWriterMemory"
+#define MDOptConfig_Aggregate                   "Aggregate"
+#define MDOptConfig_AggregatePrefix             "AggregatePrefix"
+
+// Compile time fixed configuration. Building with cmake -DWBM_FIXED_IRRIGATION=none|input|calculate defines
+// MDFixedConfig_Irrigation, and MDIrrigationOn turns the irrigation tests of the per-cell callbacks into constants
+// where the configuration decides them, so the compiler drops the branches that are never taken.
+// The run time Irrigation option then has to match the compiled one.
+#define MDFixedNone      1
+#define MDFixedInput     2
+#define MDFixedCalculate 3
+
+#if   defined(MDFixedConfig_Irrigation) && (MDFixedConfig_Irrigation == MDFixedNone)
+#define MDIrrigationOn(test) (0)
+#elif defined(MDFixedConfig_Irrigation) && (MDFixedConfig_Irrigation == MDFixedCalculate)
+#define MDIrrigationOn(test) (1)
+#else
+#define MDIrrigationOn(test) (test)
+#endif
 
 // Irrigation options
 #define MDOptIrrigation_AreaMap                 "IrrigatedAreaMap"
@@ -31,6 +62,9 @@ extern "C" {
 #define MDOptRouting_Muskingum                  "Muskingum"
 #define MDOptRouting_Riverbed                   "Riverbed"
 
+// Sediment options
+#define MDOptSediment_Stochastic                "SedimentStochastic"
+
 // Constant parameters
 #define MDParGrossRadTAU                        "GrossRadTAU"
 #define MDParGroundWatBETA                      "GroundWaterBETA"
@@ -39,6 +73,7 @@ extern "C" {
 #define	MDParSnowFallThreshold				    "SnowFallThreshold"
 #define MDParSnowMeltThreshold                  "SnowMeltThreshold"
 #define MDParRiverUptakeFraction                "RiverUptakeFraction"
+#define MDParRandomSeed                         "RandomSeed"
 
 // Auxiliary variables
 #define MDVarAux_AccBalance                     "AccumBalance"
@@ -181,6 +216,7 @@ extern "C" {
 #define MDVarReservoir_StorageChange            "ReservoirStorageChange"
 
 // Routing variables
+#define MDVarRouting_AnnualQMax                 "RiverAnnualQMax"
 #define MDVarRouting_BankfullQ                  "RiverBankfullQ"
 #define MDVarRouting_BankfullQ2                 "RiverBankfullQ2"
 #define MDVarRouting_BankfullQ5                 "RiverBankfullQ5"
@@ -563,6 +599,80 @@ float MDPETlibGroundResistance (float, float, float, float, float, float, float)
 float MDPETlibPenmanMontieth (float, float, float, float, float);
 float MDPETlibShuttleworthWallace (float, float, float, float, float, float, float, float, float);
 
+/* Counter based random numbers: n uniform (0,1) or standard normal deviates for (seed, stream, itemID, year, day),
+ * independent of the order the cells are visited in. */
+void MDRandomUniform (unsigned int, int, int, int, int, int, float *);
+void MDRandomNormal  (unsigned int, int, int, int, int, int, float *);
+
+/* Upstream sums of static layers: MDUpstreamSumDef registers the function returning a cell's own value and
+ * returns the field index into the array MDUpstreamSums gives for a cell (accumulated once a year). */
+int MDUpstreamSumDef (float (*) (int));
+const float *MDUpstreamSums (int);
+
+/* Running statistics: MDStatisticsDef tracks the count, mean (meanName) and the requested statistic of a variable in
+ * double precision, updated in one pass per time step, and returns the variable holding the statistic. A mean
+ * read as input is left alone, the running mean is then kept under <meanName>Running. */
+enum { MDStatMean, MDStatStdDev, MDStatMin, MDStatMax, MDStatNum };
+int MDStatisticsDef (int, const char *, const char *, int, const char *);
+
+/* Annual flood frequency: MDFloodFrequencyUpdate tracks the annual maxima of a daily discharge and the moments of
+ * their logarithm, MDFloodFrequencyDischarge returns the log-Pearson III discharge for a return period. */
+enum { MDFloodQ2, MDFloodQ5, MDFloodQ10, MDFloodQ25, MDFloodQ50, MDFloodQ100, MDFloodQ200, MDFloodPeriodNum };
+int   MDFloodFrequencyDef ();
+void  MDFloodFrequencyUpdate (int, float);
+float MDFloodFrequencyDischarge (int, int);
+
+/* Solar geometry cache: MDSolarGeometryGet returns func (latitude, day of year) tabulated once per grid latitude. */
+enum { MDSolarDayLength, MDSolarI0HDay, MDSolarGrossRadStd, MDSolarGrossRadOtto, MDSolarQuantityNum };
+float MDSolarGeometryGet (int, int, float (*) (float, int));
+
+/* Monthly precipitation disaggregation: MDWetDay looks up the precomputed MDEvent schedule (built by MDWetDayScheduleInit). */
+bool MDEvent (int, int, int);
+void MDWetDayScheduleInit ();
+bool MDWetDay (int, int, int);
+
+/* Parameter sweep (ParameterSweep table): modules supporting members run every member in the same pass on the shared
+ * forcing, keeping member states in <name>_mNN variables. MDParameterSweepNum returns the member count (0 without
+ * members), MDParameterSweepColumnNum the number of swept parameters. Groundwater members are recharged from the main
+ * run's infiltration, so BaseFlow only carries them when GroundWaterBETA is the only column of the table. */
+#define MDSweepMemberMax 64
+int  MDParameterSweepNum ();
+int  MDParameterSweepColumnNum ();
+bool MDParameterSweepGet (const char *, float, float *);
+int  MDParameterSweepVarDef (const char *, const char *, int, int, bool, int *);
+
+/* Binary save of module state kept outside the MF variables: MDCheckpointDef registers a section of fixed size per
+ * item records (restored from the Restart file right away), MDCheckpointInit (called from the model definition)
+ * writes the Checkpoint file at exit, to go with the end of run MF state files. No snapshots are taken mid-run. */
+int MDCheckpointInit ();
+int MDCheckpointDef (const char *, int, int (*) (), const void *(*) (int), void *(*) (int));
+
+/* Asynchronous writer of the files written by the model itself: MDWriterSubmit takes over a malloc'ed buffer and
+ * writes it (replacing or appending to the file) from the writer thread, MDWriterFlush waits for the queue to drain.
+ * Both return CMfailed once any write failed. Only the checkpoint and the aggregated outputs go through it, the per
+ * step MF output variables are still written by the framework, so their I/O cost is unchanged. */
+enum { MDWriterReplace, MDWriterAppend };
+int  MDWriterSubmit (const char *, int, void *, size_t);
+int  MDWriterFlush ();
+
+/* Temporal aggregation (Aggregate option, variable:period:statistic list) written by the output writer at the period
+ * ends, MDAggregateDef is called after the model definition. */
+int MDAggregateDef ();
+
+/* Spin-up controller (SpinUp on): MDSpinUpDef registers a storage (MFUnset when spin-up is off), MDSpinUpUpdate follows
+ * its year end value per cell and returns the storage to carry on with (extrapolated for linear reservoirs). */
+int   MDSpinUpDef (const char *, bool);
+float MDSpinUpUpdate (int, int, float);
+
+/* Module profiling (ModuleProfile on): model functions are registered through MDAux_Profile.c, which tags them
+ * with the enclosing MFDefEntering name and accumulates wall time and call counts. */
+int  MDProfileAddFunction (void (*) (int));
+void MDProfileDefEntering (const char *);
+void MDProfileDefLeaving (const char *);
+#define MFModelAddFunction(func) MDProfileAddFunction (func)
+#define MFDefEntering(name)      MDProfileDefEntering (name)
+#define MFDefLeaving(name)       MDProfileDefLeaving (name)
+
 #if defined(__cplusplus)
 }
 #endif
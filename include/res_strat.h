@@ -26,6 +26,14 @@ struct reservoir_geometry
     int gm_j;
 };
 
+struct reservoir_dav
+{
+    double d_zi[MAX_DEPTH + 1];  // Initial depth for reservoir geometry
+    double a_di[MAX_DEPTH + 1];  // Initial area for reservoir geometry
+    double v_zti[MAX_DEPTH + 1]; // Initial volume for reservoir geometry
+    int built;                   // Set once the depth-area-volume tables are filled, zero to (re)build
+};
+
 // Define subroutines from Fotran
 //void rgeom(struct reservoir_geometry *rgeom);
 //void layer_thickness(struct reservoir_geometry *rgeom);
@@ -34,3 +42,10 @@ void stratify(int ti, int *lme_error, double *in_t, double *in_f, double *ou_f,
               double *u_2, struct reservoir_geometry *resgeom,
               double *d_z[], double *t_z[], double *m_zn[],
               double *a_d[], double *d_v[], double *v_zt[], double *s_tin, double *m_cal);
+// Same as stratify, reusing the depth-area-volume tables kept by the caller in dav (built on the first call)
+// with sub-timesteps adapted to tol (K), fixed 60s sub-timesteps when tol <= 0
+void stratify_cached(struct reservoir_dav *dav, int ti, int *lme_error, double *in_t, double *in_f, double *ou_f,
+              double *coszen, double *lw_abs, double *s_w, double *rh, double *t_air,
+              double *u_2, struct reservoir_geometry *resgeom,
+              double *d_z[], double *t_z[], double *m_zn[],
+              double *a_d[], double *d_v[], double *v_zt[], double *s_tin, double *m_cal, double tol);
@@ -0,0 +1,260 @@
+/******************************************************************************
+
+GHAAS Water Balance/Transport Model
+Global Hydrological Archive and Analysis System
+Copyright 1994-2023, UNH - ASRC/CUNY
+
+MDAux_Aggregate.c
+
+bfekete@gc.cuny.edu
+
+*******************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <MF.h>
+#include <MD.h>
+
+// Temporal aggregation of model variables (Aggregate option), a comma separated list of variable:period:statistic
+// entries with period monthly, annual or climatology and statistic mean, sum, min or max, for instance
+// -p Aggregate=RiverDischarge:monthly:mean,RunoffFlow:annual:max. The running aggregates are double precision
+// state variables, so they carry over restarts. At the end of every period the results are handed to the output
+// writer, which appends a record (year, month (0 for annual), item number, then one float per item) to
+// <AggregatePrefix><variable>_<period>_<statistic>.bin. Monthly and annual files are only ever appended to, so a
+// restarted run continues the file of the earlier periods (fresh runs should start without the old files), while
+// climatologies are rewritten at every year end as twelve monthly records over all the years so far. Items without
+// a value are set to MDAggregateMissing.
+
+#define MDAggregateNumMax  16
+#define MDAggregateNameLen 128
+#define MDAggregateMissing -9999.0
+
+enum { MDAggMonthly, MDAggAnnual, MDAggClimatology };
+enum { MDAggMean, MDAggSum, MDAggMin, MDAggMax };
+
+typedef struct MDAggregate_s {
+	int    InputID;
+	int    Period, Stat, SlotNum;
+	int    AccIDs [12], CountIDs [12];
+	char   AccNames [12][MDAggregateNameLen], CountNames [12][MDAggregateNameLen];
+	char   FileName [MDAggregateNameLen * 2];
+	float *Values; // SlotNum values per item
+	int    ItemNum, ItemCap, Date; // Date of the period end as yyyymmdd
+	bool   Pending; // period closed, not handed to the writer yet
+} MDAggregate_t;
+
+static MDAggregate_t _MDAggregates [MDAggregateNumMax];
+static int _MDAggregateNum = MFUnset;
+static pthread_mutex_t _MDAggregateMutex = PTHREAD_MUTEX_INITIALIZER;
+
+// Model variables that need their module defined first, others are looked up as they are.
+static struct { const char *Name; const char *Unit; int Flux; int (*Def) (); } _MDAggregateVars [] = {
+	{ MDVarRouting_Discharge,       "m3/s", MFState, MDRouting_DischargeDef },
+	{ MDVarCore_RunoffFlow,         "m3/s", MFState, MDCore_RunoffFlowDef },
+	{ MDVarCore_Evapotranspiration, "mm",   MFFlux,  MDCore_EvapotranspirationDef },
+	{ MDVarCore_SoilMoisture,       "mm",   MFState, MDCore_SoilMoistChgDef },
+	{ MDVarWTemp_River,             "degC", MFState, MDWTemp_RiverDef },
+	{ (const char *) NULL,          MFNoUnit, MFState, NULL } };
+
+static void _MDAggregateFlush (MDAggregate_t *agg) {
+	int slot, itemID, header [3];
+	size_t size;
+	char *buffer, *cursor;
+
+	pthread_mutex_lock (&_MDAggregateMutex);
+	if (agg->Pending) {
+		size = agg->SlotNum * (sizeof (header) + agg->ItemNum * sizeof (float));
+		if ((buffer = (char *) malloc (size)) == (char *) NULL)
+			CMmsgPrint (CMmsgSysError, "Memory allocation error in: %s:%d", __FILE__, __LINE__);
+		else {
+			for (cursor = buffer, slot = 0; slot < agg->SlotNum; ++slot) {
+				header [0] = agg->Period == MDAggClimatology ? 0 : agg->Date / 10000;
+				header [1] = agg->Period == MDAggClimatology ? slot + 1 : (agg->Period == MDAggMonthly ? (agg->Date / 100) % 100 : 0);
+				header [2] = agg->ItemNum;
+				memcpy (cursor, header, sizeof (header));
+				cursor += sizeof (header);
+				for (itemID = 0; itemID < agg->ItemNum; ++itemID, cursor += sizeof (float))
+					memcpy (cursor, agg->Values + itemID * agg->SlotNum + slot, sizeof (float));
+			}
+			if (MDWriterSubmit (agg->FileName, agg->Period == MDAggClimatology ? MDWriterReplace : MDWriterAppend, buffer, size) == CMfailed)
+				CMmsgPrint (CMmsgUsrError, "Aggregated output [%s] writing failed\n", agg->FileName);
+		}
+		agg->Pending = false;
+	}
+	pthread_mutex_unlock (&_MDAggregateMutex);
+}
+
+static void _MDAggregateExit () {
+	int aggID;
+
+	for (aggID = 0; aggID < _MDAggregateNum; ++aggID) _MDAggregateFlush (_MDAggregates + aggID);
+	if (MDWriterFlush () == CMfailed) CMmsgPrint (CMmsgUsrError, "Aggregated outputs may be incomplete\n");
+}
+
+static void _MDAggregateStore (MDAggregate_t *agg, int itemID, int date, const float *results) {
+	int itemNum, i;
+	float *values;
+
+	pthread_mutex_lock (&_MDAggregateMutex);
+	if (itemID >= agg->ItemCap) {
+		itemNum = itemID + 1 > 2 * agg->ItemCap ? itemID + 1 : 2 * agg->ItemCap;
+		if ((values = (float *) realloc (agg->Values, itemNum * agg->SlotNum * sizeof (float))) == (float *) NULL) {
+			CMmsgPrint (CMmsgSysError, "Memory allocation error in: %s:%d", __FILE__, __LINE__);
+			pthread_mutex_unlock (&_MDAggregateMutex);
+			return;
+		}
+		for (i = agg->ItemCap * agg->SlotNum; i < itemNum * agg->SlotNum; ++i) values [i] = MDAggregateMissing;
+		agg->Values  = values;
+		agg->ItemCap = itemNum;
+	}
+	if (itemID >= agg->ItemNum) agg->ItemNum = itemID + 1;
+	memcpy (agg->Values + itemID * agg->SlotNum, results, agg->SlotNum * sizeof (float));
+	agg->Date    = date;
+	agg->Pending = true;
+	pthread_mutex_unlock (&_MDAggregateMutex);
+}
+
+static float _MDAggregateResult (MDAggregate_t *agg, double acc, int count) {
+	if (count == 0) return (MDAggregateMissing);
+	return (agg->Stat == MDAggMean ? acc / (double) count : acc);
+}
+
+static void _MDAggregate (int aggID, int itemID) {
+	MDAggregate_t *agg = _MDAggregates + aggID;
+	int    slot = agg->Period == MDAggClimatology ? MFDateGetCurrentMonth () - 1 : 0;
+	int    date = MFDateGetCurrentYear () * 10000 + MFDateGetCurrentMonth () * 100 + MFDateGetCurrentDay ();
+	int    count, i;
+	double value, acc;
+	float  results [12];
+
+	if (__atomic_load_n (&agg->Pending, __ATOMIC_RELAXED) && (__atomic_load_n (&agg->Date, __ATOMIC_RELAXED) != date)) _MDAggregateFlush (agg);
+	value = MFVarGetFloat (agg->InputID,         itemID, 0.0);
+	count = MFVarGetInt   (agg->CountIDs [slot], itemID, 0);
+	acc   = MFVarGetFloat (agg->AccIDs   [slot], itemID, 0.0);
+	switch (agg->Stat) {
+		case MDAggMin: acc = (count == 0) || (value < acc) ? value : acc; break;
+		case MDAggMax: acc = (count == 0) || (value > acc) ? value : acc; break;
+		default:       acc = count == 0 ? value : acc + value; break;
+	}
+	count++;
+	MFVarSetFloat (agg->AccIDs [slot], itemID, acc);
+	switch (agg->Period) {
+		case MDAggMonthly:
+		case MDAggAnnual:
+			if (agg->Period == MDAggMonthly ? MFDateGetCurrentDay () != MFDateGetMonthLength () : MFDateGetDayOfYear () != MFDateGetYearLength ()) break;
+			results [0] = _MDAggregateResult (agg, acc, count);
+			_MDAggregateStore (agg, itemID, date, results);
+			count = 0;
+			break;
+		case MDAggClimatology:
+			if (MFDateGetDayOfYear () != MFDateGetYearLength ()) break;
+			for (i = 0; i < 12; ++i)
+				results [i] = i == slot ? _MDAggregateResult (agg, acc, count) :
+				              _MDAggregateResult (agg, MFVarGetFloat (agg->AccIDs [i], itemID, 0.0), MFVarGetInt (agg->CountIDs [i], itemID, 0));
+			_MDAggregateStore (agg, itemID, date, results);
+			break;
+	}
+	MFVarSetInt (agg->CountIDs [slot], itemID, count);
+}
+
+// The framework callbacks carry no user data, so each aggregate gets its own entry point.
+#define MDAggregateTramp(i) static void _MDAggregateTramp##i (int itemID) { _MDAggregate (i, itemID); }
+MDAggregateTramp(0)  MDAggregateTramp(1)  MDAggregateTramp(2)  MDAggregateTramp(3)
+MDAggregateTramp(4)  MDAggregateTramp(5)  MDAggregateTramp(6)  MDAggregateTramp(7)
+MDAggregateTramp(8)  MDAggregateTramp(9)  MDAggregateTramp(10) MDAggregateTramp(11)
+MDAggregateTramp(12) MDAggregateTramp(13) MDAggregateTramp(14) MDAggregateTramp(15)
+
+static void (*_MDAggregateTramps [MDAggregateNumMax]) (int) = {
+	_MDAggregateTramp0,  _MDAggregateTramp1,  _MDAggregateTramp2,  _MDAggregateTramp3,
+	_MDAggregateTramp4,  _MDAggregateTramp5,  _MDAggregateTramp6,  _MDAggregateTramp7,
+	_MDAggregateTramp8,  _MDAggregateTramp9,  _MDAggregateTramp10, _MDAggregateTramp11,
+	_MDAggregateTramp12, _MDAggregateTramp13, _MDAggregateTramp14, _MDAggregateTramp15 };
+
+static int _MDAggregateAdd (const char *varName, int period, int stat, const char *prefix) {
+	const char *periods [] = { "Monthly", "Annual", "Clim" };
+	const char *stats   [] = { "Mean", "Sum", "Min", "Max" };
+	int var, slot;
+	MDAggregate_t *agg;
+
+	if (_MDAggregateNum == MDAggregateNumMax) {
+		CMmsgPrint (CMmsgUsrError, "Too many aggregates [%s] in: %s:%d\n", varName, __FILE__, __LINE__);
+		return (CMfailed);
+	}
+	agg = _MDAggregates + _MDAggregateNum;
+	agg->Period    = period;
+	agg->Stat      = stat;
+	agg->SlotNum   = period == MDAggClimatology ? 12 : 1;
+	agg->Values    = (float *) NULL;
+	agg->ItemNum   = agg->ItemCap = agg->Date = 0;
+	agg->Pending   = false;
+	for (var = 0; _MDAggregateVars [var].Name != (const char *) NULL; ++var)
+		if (strcmp (_MDAggregateVars [var].Name, varName) == 0) break;
+	if (_MDAggregateVars [var].Def != NULL) {
+		if ((_MDAggregateVars [var].Def () == CMfailed) ||
+		    ((agg->InputID = MFVarGetID ((char *) varName, (char *) _MDAggregateVars [var].Unit, MFInput, _MDAggregateVars [var].Flux, MFBoundary)) == CMfailed)) return (CMfailed);
+	}
+	else if ((agg->InputID = MFVarGetID ((char *) varName, MFNoUnit, MFInput, MFState, MFBoundary)) == CMfailed) return (CMfailed);
+
+	snprintf (agg->FileName, sizeof (agg->FileName), "%s%s_%s_%s.bin", prefix, varName, periods [period], stats [stat]);
+	for (slot = 0; slot < agg->SlotNum; ++slot) {
+		if (period == MDAggClimatology) {
+			snprintf (agg->AccNames   [slot], MDAggregateNameLen, "%s_%s%sAcc%02d",   varName, periods [period], stats [stat], slot + 1);
+			snprintf (agg->CountNames [slot], MDAggregateNameLen, "%s_%s%sCount%02d", varName, periods [period], stats [stat], slot + 1);
+		} else {
+			snprintf (agg->AccNames   [slot], MDAggregateNameLen, "%s_%s%sAcc",   varName, periods [period], stats [stat]);
+			snprintf (agg->CountNames [slot], MDAggregateNameLen, "%s_%s%sCount", varName, periods [period], stats [stat]);
+		}
+		if (((agg->AccIDs   [slot] = MFVarGetID (agg->AccNames   [slot], MFNoUnit, MFDouble, MFState, MFInitial)) == CMfailed) ||
+		    ((agg->CountIDs [slot] = MFVarGetID (agg->CountNames [slot], MFNoUnit, MFInt,    MFState, MFInitial)) == CMfailed)) return (CMfailed);
+	}
+	if (MFModelAddFunction (_MDAggregateTramps [_MDAggregateNum]) == CMfailed) return (CMfailed);
+	CMmsgPrint (CMmsgInfo, "Aggregate: %s\n", agg->FileName);
+	return (_MDAggregateNum++);
+}
+
+// Registers the aggregates of the Aggregate option, called once the model is defined.
+int MDAggregateDef () {
+	int period, stat;
+	const char *optStr, *prefix;
+	const char *periods [] = { "monthly", "annual", "climatology", (char *) NULL };
+	const char *stats   [] = { "mean", "sum", "min", "max", (char *) NULL };
+	char *spec, *entry, *varName, *periodStr, *statStr, *save;
+
+	if (_MDAggregateNum != MFUnset) return (_MDAggregateNum);
+	_MDAggregateNum = 0;
+	if ((optStr = MFOptionGet (MDOptConfig_Aggregate)) == (char *) NULL) return (0);
+	if ((prefix = MFOptionGet (MDOptConfig_AggregatePrefix)) == (char *) NULL) prefix = "";
+	if ((spec = strdup (optStr)) == (char *) NULL) {
+		CMmsgPrint (CMmsgSysError, "Memory allocation error in: %s:%d", __FILE__, __LINE__);
+		return (CMfailed);
+	}
+	MFDefEntering ("Aggregate");
+	for (entry = strtok_r (spec, ",", &save); entry != (char *) NULL; entry = strtok_r ((char *) NULL, ",", &save)) {
+		varName   = entry;
+		periodStr = strchr (varName, ':');
+		statStr   = periodStr != (char *) NULL ? strchr (periodStr + 1, ':') : (char *) NULL;
+		if (statStr == (char *) NULL) {
+			CMmsgPrint (CMmsgUsrError, "Invalid aggregate [%s], variable:period:statistic expected in: %s:%d\n", entry, __FILE__, __LINE__);
+			free (spec);
+			return (CMfailed);
+		}
+		*periodStr++ = *statStr++ = '\0';
+		if ((period = CMoptLookup (periods, periodStr, true)) == CMfailed) {
+			MFOptionMessage (MDOptConfig_Aggregate, periodStr, periods);
+			free (spec);
+			return (CMfailed);
+		}
+		if ((stat = CMoptLookup (stats, statStr, true)) == CMfailed) {
+			MFOptionMessage (MDOptConfig_Aggregate, statStr, stats);
+			free (spec);
+			return (CMfailed);
+		}
+		if (_MDAggregateAdd (varName, period, stat, prefix) == CMfailed) { free (spec); return (CMfailed); }
+	}
+	free (spec);
+	if (_MDAggregateNum > 0) atexit (_MDAggregateExit);
+	MFDefLeaving ("Aggregate");
+	return (_MDAggregateNum);
+}
@@ -13,20 +13,10 @@ bfekete@gc.cuny.edu
 #include <MF.h>
 #include <MD.h>
 
-static int _MDInAux_StepCounterID         = MFUnset;
 static int _MDInAux_AirTemperatureID      = MFUnset;
 
 static int _MDOutAux_AirTemperatureMeanID = MFUnset;
 
-static void _MDAux_AirTemperatureMean (int itemID) {
-	int   tStep       = MFVarGetInt   (_MDInAux_StepCounterID,         itemID,   0);
-	float airTemp     = MFVarGetFloat (_MDInAux_AirTemperatureID,      itemID, 0.0);
-	float airTempMean = MFVarGetFloat (_MDOutAux_AirTemperatureMeanID, itemID, 0.0);
-
-	airTempMean = (float) (((double) airTempMean * (double) tStep + airTemp) / ((double) (tStep + 1)));
-	MFVarSetFloat (_MDOutAux_AirTemperatureMeanID, itemID, airTempMean);
-}
-
 int MDAux_AirTemperatureMeanDef () {
 	int  optID = MFcalculate;
 	const char *optStr;
@@ -40,10 +30,8 @@ int MDAux_AirTemperatureMeanDef () {
 		case MFhelp:  MFOptionMessage (MDVarAux_AirTemperatureMean, optStr, MFsourceOptions); return (CMfailed);
 		case MFinput: _MDOutAux_AirTemperatureMeanID = MFVarGetID (MDVarAux_AirTemperatureMean, "degC", MFInput, MFState, MFBoundary); break;
 		case MFcalculate:
-			if (((_MDInAux_StepCounterID         = MDAux_StepCounterDef ())       == CMfailed) ||
-			    ((_MDInAux_AirTemperatureID      = MDCommon_AirTemperatureDef ()) == CMfailed) ||
-                ((_MDOutAux_AirTemperatureMeanID = MFVarGetID (MDVarAux_AirTemperatureMean, "degC", MFOutput, MFState, MFInitial)) == CMfailed) ||
-                (MFModelAddFunction(_MDAux_AirTemperatureMean) == CMfailed)) return (CMfailed);
+			if (((_MDInAux_AirTemperatureID      = MDCommon_AirTemperatureDef ()) == CMfailed) ||
+                ((_MDOutAux_AirTemperatureMeanID = MDStatisticsDef (_MDInAux_AirTemperatureID, MDVarAux_AirTemperatureMean, "degC", MDStatMean, MDVarAux_AirTemperatureMean)) == CMfailed)) return (CMfailed);
 			break;
 	}
 	MFDefLeaving ("Mean Air Temperature");
@@ -0,0 +1,158 @@
+/******************************************************************************
+
+GHAAS Water Balance/Transport Model
+Global Hydrological Archive and Analysis System
+Copyright 1994-2023, UNH - ASRC/CUNY
+
+MDAux_Checkpoint.c
+
+bfekete@gc.cuny.edu
+
+*******************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <MF.h>
+#include <MD.h>
+
+// Binary save of the model state that modules keep outside the MF variables. Modules register a section of fixed
+// size per item records, which are written to the Checkpoint file at exit, after the last time step, so they go
+// with the state files MF writes at the end of the run. Starting a run from those MF state files with the Restart
+// option pointing to this file reads the records back when the section is registered. Snapshots during the run
+// are not taken: the MF variables cannot be saved at the same step boundary, so a mid-run file would pair module
+// records with MF state from another date.
+
+#define MDCheckpointMagic      "WBMCKPT2"
+#define MDCheckpointNameLen    32
+#define MDCheckpointSectionMax 16
+
+typedef struct MDCheckpointSection_s {
+	char   Name [MDCheckpointNameLen];
+	size_t RecordSize;
+	int          (*ItemNum)   ();
+	const void * (*RecordGet) (int);
+	void *       (*RecordSet) (int);
+} MDCheckpointSection_t;
+
+static MDCheckpointSection_t _MDCheckpointSections [MDCheckpointSectionMax];
+static int _MDCheckpointSectionNum = 0;
+static const char *_MDCheckpointFileName = (const char *) NULL;
+
+static char *_MDCheckpointPut (char *cursor, const void *data, size_t size) {
+	memcpy (cursor, data, size);
+	return (cursor + size);
+}
+
+// Encodes the sections and hands them to the output writer.
+static int _MDCheckpointWrite () {
+	int section, itemID, recordNum, header [2];
+	size_t size = strlen (MDCheckpointMagic) + sizeof (int);
+	char *buffer, *cursor;
+	const void *record;
+	MDCheckpointSection_t *sect;
+
+	for (section = 0; section < _MDCheckpointSectionNum; ++section) {
+		sect = _MDCheckpointSections + section;
+		size += MDCheckpointNameLen + 2 * sizeof (int);
+		for (itemID = 0; itemID < sect->ItemNum (); ++itemID)
+			if (sect->RecordGet (itemID) != (const void *) NULL) size += sizeof (int) + sect->RecordSize;
+	}
+	if ((buffer = (char *) malloc (size)) == (char *) NULL) {
+		CMmsgPrint (CMmsgSysError, "Memory allocation error in: %s:%d", __FILE__, __LINE__);
+		return (CMfailed);
+	}
+	cursor = _MDCheckpointPut (buffer, MDCheckpointMagic, strlen (MDCheckpointMagic));
+	cursor = _MDCheckpointPut (cursor, &_MDCheckpointSectionNum, sizeof (int));
+	for (section = 0; section < _MDCheckpointSectionNum; ++section) {
+		sect = _MDCheckpointSections + section;
+		for (recordNum = itemID = 0; itemID < sect->ItemNum (); ++itemID)
+			if (sect->RecordGet (itemID) != (const void *) NULL) recordNum++;
+		header [0] = (int) sect->RecordSize;
+		header [1] = recordNum;
+		cursor = _MDCheckpointPut (cursor, sect->Name, MDCheckpointNameLen);
+		cursor = _MDCheckpointPut (cursor, header, 2 * sizeof (int));
+		for (itemID = 0; itemID < sect->ItemNum (); ++itemID) {
+			if ((record = sect->RecordGet (itemID)) == (const void *) NULL) continue;
+			cursor = _MDCheckpointPut (cursor, &itemID, sizeof (int));
+			cursor = _MDCheckpointPut (cursor, record, sect->RecordSize);
+		}
+	}
+	return (MDWriterSubmit (_MDCheckpointFileName, MDWriterReplace, buffer, size));
+}
+
+static void _MDCheckpointExit () {
+	if ((_MDCheckpointWrite () == CMfailed) || (MDWriterFlush () == CMfailed))
+		CMmsgPrint (CMmsgUsrError, "Checkpoint [%s] writing failed\n", _MDCheckpointFileName);
+	else CMmsgPrint (CMmsgInfo, "Checkpoint [%s] written\n", _MDCheckpointFileName);
+}
+
+// Called from the model definition, arranges the Checkpoint file to be written at exit.
+int MDCheckpointInit () {
+	if ((_MDCheckpointFileName != (const char *) NULL) || ((_MDCheckpointFileName = MFOptionGet (MDOptConfig_Checkpoint)) == (char *) NULL)) return (0);
+	atexit (_MDCheckpointExit);
+	return (0);
+}
+
+static int _MDCheckpointRestore (MDCheckpointSection_t *sect, const char *fileName) {
+	int section, sectionNum, record, itemID, header [2];
+	char magic [8], name [MDCheckpointNameLen];
+	void *buffer;
+	FILE *inFile;
+
+	if ((inFile = fopen (fileName, "rb")) == (FILE *) NULL) {
+		CMmsgPrint (CMmsgUsrError, "Restart file [%s] opening error in: %s:%d\n", fileName, __FILE__, __LINE__);
+		return (CMfailed);
+	}
+	if ((fread (magic, 1, sizeof (magic), inFile) != sizeof (magic)) || (strncmp (magic, MDCheckpointMagic, sizeof (magic)) != 0) ||
+	    (fread (&sectionNum, sizeof (int), 1, inFile) != 1)) {
+		CMmsgPrint (CMmsgUsrError, "Restart file [%s] is not a checkpoint in: %s:%d\n", fileName, __FILE__, __LINE__);
+		fclose (inFile);
+		return (CMfailed);
+	}
+	for (section = sectionNum; section > 0; --section) {
+		if ((fread (name, 1, MDCheckpointNameLen, inFile) != MDCheckpointNameLen) || (fread (header, sizeof (int), 2, inFile) != 2)) break;
+		if (strncmp (name, sect->Name, MDCheckpointNameLen) != 0) {
+			if (fseek (inFile, (long) header [1] * (sizeof (int) + header [0]), SEEK_CUR) != 0) break;
+			continue;
+		}
+		if ((size_t) header [0] != sect->RecordSize) {
+			CMmsgPrint (CMmsgUsrError, "Restart section [%s] record size mismatch (%d instead of %d) in: %s:%d\n", sect->Name, header [0], (int) sect->RecordSize, __FILE__, __LINE__);
+			fclose (inFile);
+			return (CMfailed);
+		}
+		for (record = 0; record < header [1]; ++record) {
+			if (fread (&itemID, sizeof (int), 1, inFile) != 1) break;
+			if ((buffer = sect->RecordSet (itemID)) == (void *) NULL) { fclose (inFile); return (CMfailed); }
+			if (fread (buffer, sect->RecordSize, 1, inFile) != 1) break;
+		}
+		fclose (inFile);
+		if (record < header [1]) {
+			CMmsgPrint (CMmsgUsrError, "Restart file [%s] is truncated in: %s:%d\n", fileName, __FILE__, __LINE__);
+			return (CMfailed);
+		}
+		CMmsgPrint (CMmsgInfo, "Restart section [%s]: %d records\n", sect->Name, header [1]);
+		return (0);
+	}
+	fclose (inFile);
+	CMmsgPrint (CMmsgWarning, "Restart file [%s] has no [%s] section\n", fileName, sect->Name);
+	return (0);
+}
+
+int MDCheckpointDef (const char *name, int recordSize, int (*itemNum) (), const void *(*recordGet) (int), void *(*recordSet) (int)) {
+	const char *fileName;
+	MDCheckpointSection_t *sect;
+
+	if (_MDCheckpointSectionNum == MDCheckpointSectionMax) {
+		CMmsgPrint (CMmsgAppError, "Too many checkpoint sections [%s] in: %s:%d\n", name, __FILE__, __LINE__);
+		return (CMfailed);
+	}
+	sect = _MDCheckpointSections + _MDCheckpointSectionNum;
+	strncpy (sect->Name, name, MDCheckpointNameLen - 1);
+	sect->RecordSize = (size_t) recordSize;
+	sect->ItemNum    = itemNum;
+	sect->RecordGet  = recordGet;
+	sect->RecordSet  = recordSet;
+	if (((fileName = MFOptionGet (MDOptConfig_Restart)) != (char *) NULL) && (_MDCheckpointRestore (sect, fileName) == CMfailed)) return (CMfailed);
+	return (_MDCheckpointSectionNum++);
+}
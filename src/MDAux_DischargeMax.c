@@ -17,14 +17,6 @@ static int _MDInAux_AccumRunoffID       = MFUnset;
 
 static int _MDOutAux_MaximumDischargeID = MFUnset;
 
-static void _MDAux_MaximumDischarge (int itemID) {
-	float discharge  = MFVarGetFloat (_MDOutAux_MaximumDischargeID, itemID, 0.0);
-	float accumDisch = MFVarGetFloat (_MDInAux_AccumRunoffID,       itemID, 0.0);
-
-	discharge  = discharge > accumDisch ? discharge : accumDisch;
-	MFVarSetFloat (_MDOutAux_MaximumDischargeID, itemID, discharge);
-}
-
 int MDAux_DischargeMaxDef () {
 	int  optID = MFinput;
 	const char *optStr;
@@ -39,8 +31,7 @@ int MDAux_DischargeMaxDef () {
 		case MFinput: _MDOutAux_MaximumDischargeID = MFVarGetID (MDVarAux_DischargeMean, "m3/s", MFInput, MFState, MFInitial); break;
 		case MFcalculate:
 			if (((_MDInAux_AccumRunoffID        = MDAux_AccumRunoffDef()) == CMfailed) ||
-                ((_MDOutAux_MaximumDischargeID  = MFVarGetID (MDVarAux_DischargeMax,  "m3/s", MFOutput, MFState, MFInitial)) == CMfailed) ||
-                (MFModelAddFunction(_MDAux_MaximumDischarge) == CMfailed)) return (CMfailed);
+                ((_MDOutAux_MaximumDischargeID  = MDStatisticsDef (_MDInAux_AccumRunoffID, MDVarAux_DischargeMean, "m3/s", MDStatMax, MDVarAux_DischargeMax)) == CMfailed)) return (CMfailed);
 			break;
 	}
 	MFDefLeaving ("Discharge Maximum");
@@ -13,20 +13,10 @@ bfekete@gc.cuny.edu
 #include <MF.h>
 #include <MD.h>
 
-static int _MDInAux_StepCounterID    = MFUnset;
 static int _MDInAux_AccumRunoffID    = MFUnset;
 
 static int _MDOutAux_DischargeMeanID = MFUnset;
 
-static void _MDAux_DischargeMean (int itemID) {
-	int   tStep      = MFVarGetInt   (_MDInAux_StepCounterID,    itemID,   0);
-	float accumDisch = MFVarGetFloat (_MDInAux_AccumRunoffID,    itemID, 0.0);
-	float dischMean  = MFVarGetFloat (_MDOutAux_DischargeMeanID, itemID, 0.0);
-
-	dischMean  = (float) (((double) dischMean * (double) tStep + accumDisch) / ((double) (tStep + 1)));
-	MFVarSetFloat (_MDOutAux_DischargeMeanID, itemID, dischMean);
-}
-
 int MDAux_DischargeMeanDef () {
 	int  optID = MFcalculate;
 	const char *optStr;
@@ -40,10 +30,8 @@ int MDAux_DischargeMeanDef () {
 		case MFhelp:  MFOptionMessage (MDVarAux_DischargeMean, optStr, MFsourceOptions); return (CMfailed);
 		case MFinput: _MDOutAux_DischargeMeanID = MFVarGetID (MDVarAux_DischargeMean, "m3/s", MFInput, MFState, MFBoundary); break;
 		case MFcalculate:
-			if (((_MDInAux_StepCounterID    = MDAux_StepCounterDef()) == CMfailed) ||
-			    ((_MDInAux_AccumRunoffID    = MDAux_AccumRunoffDef()) == CMfailed) ||
-                ((_MDOutAux_DischargeMeanID = MFVarGetID (MDVarAux_DischargeMean, "m3/s", MFOutput, MFState, MFInitial)) == CMfailed) ||
-                (MFModelAddFunction(_MDAux_DischargeMean) == CMfailed)) return (CMfailed);
+			if (((_MDInAux_AccumRunoffID    = MDAux_AccumRunoffDef()) == CMfailed) ||
+                ((_MDOutAux_DischargeMeanID = MDStatisticsDef (_MDInAux_AccumRunoffID, MDVarAux_DischargeMean, "m3/s", MDStatMean, MDVarAux_DischargeMean)) == CMfailed)) return (CMfailed);
 			break;
 	}
 	MFDefLeaving ("Discharge Mean");
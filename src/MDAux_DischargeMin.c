@@ -13,20 +13,10 @@ bfekete@gc.cuny.edu
 #include <MF.h>
 #include <MD.h>
 
-static int _MDInAux_AccumRunoffID = MFUnset;
-static int _MDInAux_StepCounterID = MFUnset;
+static int _MDInAux_AccumRunoffID   = MFUnset;
 
 static int _MDOutAux_DischargeMinID = MFUnset;
 
-static void _MDAux_DischargeMin (int itemID) {
-	int   tStep      = MFVarGetInt   (_MDInAux_StepCounterID,       itemID, 0);
-	float discharge  = MFVarGetFloat (_MDOutAux_DischargeMinID, itemID, 0.0);
-	float accumDisch = tStep > 0 ? MFVarGetFloat (_MDInAux_AccumRunoffID, itemID, 0.0) : discharge;
-
-	discharge  = discharge < accumDisch ? discharge : accumDisch;
-	MFVarSetFloat (_MDOutAux_DischargeMinID, itemID, discharge);
-}
-
 int MDAux_DischargeMinDef () {
 	int  optID = MFinput;
 	const char *optStr;
@@ -41,9 +31,7 @@ int MDAux_DischargeMinDef () {
 		case MFinput: _MDOutAux_DischargeMinID = MFVarGetID (MDVarAux_DischargeMean, "m3/s", MFInput, MFState, MFInitial); break;
 		case MFcalculate:
 			if (((_MDInAux_AccumRunoffID   = MDAux_AccumRunoffDef()) == CMfailed) ||
-				((_MDInAux_StepCounterID   = MDAux_StepCounterDef()) == CMfailed) ||
-                ((_MDOutAux_DischargeMinID = MFVarGetID (MDVarAux_DischargeMin,  "m3/s", MFOutput, MFState, MFInitial)) == CMfailed) ||
-                (MFModelAddFunction(_MDAux_DischargeMin) == CMfailed)) return (CMfailed);
+                ((_MDOutAux_DischargeMinID = MDStatisticsDef (_MDInAux_AccumRunoffID, MDVarAux_DischargeMean, "m3/s", MDStatMin, MDVarAux_DischargeMin)) == CMfailed)) return (CMfailed);
 			break;
 	}
 	MFDefLeaving ("Discharge Minimum");
@@ -0,0 +1,104 @@
+/******************************************************************************
+
+GHAAS Water Balance/Transport Model
+Global Hydrological Archive and Analysis System
+Copyright 1994-2023, UNH - ASRC/CUNY
+
+MDAux_ParameterSweep.c
+
+bfekete@gc.cuny.edu
+
+*******************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <MF.h>
+#include <MD.h>
+
+// Parameter sweep table (ParameterSweep option): a header line of parameter names followed by one line of values per
+// sweep member, blank and '#' lines are skipped. Modules that support sweeps carry every member through the same
+// run on the shared forcing, keeping the member states side by side.
+
+#define MDSweepColumnMax 32
+#define MDSweepLineLen   1024
+
+static int    _MDSweepMemberNum = MFUnset;
+static int    _MDSweepColumnNum = 0;
+static char   _MDSweepNames [MDSweepColumnMax][MDSweepLineLen / 8];
+static float *_MDSweepValues    = (float *) NULL; // member major
+
+static int _MDSweepLoad () {
+	int column, member = 0;
+	char buffer [MDSweepLineLen], *token;
+	const char *fileName;
+	float *values;
+	FILE *inFile;
+
+	_MDSweepMemberNum = 0;
+	if ((fileName = MFOptionGet (MDOptConfig_ParameterSweep)) == (char *) NULL) return (0);
+	if ((inFile = fopen (fileName, "r")) == (FILE *) NULL) {
+		CMmsgPrint (CMmsgUsrError, "Parameter sweep file [%s] opening error in: %s:%d\n", fileName, __FILE__, __LINE__);
+		return (CMfailed);
+	}
+	while (fgets (buffer, sizeof (buffer), inFile) != (char *) NULL) {
+		if (((token = strtok (buffer, " \t\r\n,")) == (char *) NULL) || (token [0] == '#')) continue;
+		if (_MDSweepColumnNum == 0) {
+			for ( ; (token != (char *) NULL) && (_MDSweepColumnNum < MDSweepColumnMax); token = strtok ((char *) NULL, " \t\r\n,"))
+				strncpy (_MDSweepNames [_MDSweepColumnNum++], token, sizeof (_MDSweepNames [0]) - 1);
+			continue;
+		}
+		if ((values = (float *) realloc (_MDSweepValues, (member + 1) * _MDSweepColumnNum * sizeof (float))) == (float *) NULL) {
+			CMmsgPrint (CMmsgSysError, "Memory allocation error in: %s:%d", __FILE__, __LINE__);
+			fclose (inFile);
+			return (CMfailed);
+		}
+		_MDSweepValues = values;
+		for (column = 0; column < _MDSweepColumnNum; ++column, token = strtok ((char *) NULL, " \t\r\n,")) {
+			if ((token == (char *) NULL) || (sscanf (token, "%f", values + member * _MDSweepColumnNum + column) != 1)) {
+				CMmsgPrint (CMmsgUsrError, "Parameter sweep file [%s] member %d column %d error in: %s:%d\n", fileName, member + 1, column + 1, __FILE__, __LINE__);
+				fclose (inFile);
+				return (CMfailed);
+			}
+		}
+		member++;
+	}
+	fclose (inFile);
+	if (member > MDSweepMemberMax) {
+		CMmsgPrint (CMmsgUsrError, "Parameter sweep file [%s] has %d members, more than %d in: %s:%d\n", fileName, member, MDSweepMemberMax, __FILE__, __LINE__);
+		return (CMfailed);
+	}
+	CMmsgPrint (CMmsgInfo, "Parameter sweep: %d members, %d parameters\n", member, _MDSweepColumnNum);
+	_MDSweepMemberNum = member;
+	return (0);
+}
+
+int MDParameterSweepNum () {
+	if ((_MDSweepMemberNum == MFUnset) && (_MDSweepLoad () == CMfailed)) return (CMfailed);
+	return (_MDSweepMemberNum);
+}
+
+int MDParameterSweepColumnNum () { return (_MDSweepColumnNum); }
+
+// Fills the member values of a parameter, members get defaultValue when the table has no such column.
+bool MDParameterSweepGet (const char *name, float defaultValue, float *values) {
+	int column, member;
+
+	for (column = 0; column < _MDSweepColumnNum; ++column)
+		if (strcmp (_MDSweepNames [column], name) == 0) break;
+	for (member = 0; member < _MDSweepMemberNum; ++member)
+		values [member] = column < _MDSweepColumnNum ? _MDSweepValues [member * _MDSweepColumnNum + column] : defaultValue;
+	return (column < _MDSweepColumnNum);
+}
+
+// Registers the member variables of a swept quantity (<name>_m01, <name>_m02 ...)
+int MDParameterSweepVarDef (const char *name, const char *unit, int type, int flux, bool initial, int *varIDs) {
+	int member;
+	char varName [128];
+
+	for (member = 0; member < _MDSweepMemberNum; ++member) {
+		snprintf (varName, sizeof (varName), "%s_m%02d", name, member + 1);
+		if ((varIDs [member] = MFVarGetID (varName, (char *) unit, type, flux, initial)) == CMfailed) return (CMfailed);
+	}
+	return (0);
+}
@@ -0,0 +1,198 @@
+/******************************************************************************
+
+GHAAS Water Balance/Transport Model
+Global Hydrological Archive and Analysis System
+Copyright 1994-2023, UNH - ASRC/CUNY
+
+MDAux_Profile.c
+
+bfekete@gc.cuny.edu
+
+*******************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <pthread.h>
+#include <MF.h>
+#include <MD.h>
+
+// This file registers with the framework itself.
+#undef MFModelAddFunction
+#undef MFDefEntering
+#undef MFDefLeaving
+
+#define MDProfileSlotNum  128
+#define MDProfileDepthMax 64
+
+typedef struct MDProfileSlot_s {
+	void (*Func) (int);
+	const char *Name;
+	long long Calls;     // total number of calls (cells processed)
+	long long Nanosecs;  // total wall time
+	long long StepCalls; // calls in the current time step
+	long long StepNanosecs;
+	long long StepMax;   // most cells processed in a single time step
+	int       Steps;     // time steps the callback was active in
+} MDProfileSlot_t;
+
+static MDProfileSlot_t _MDProfileSlots [MDProfileSlotNum];
+static int  _MDProfileSlotNum = 0;
+static int  _MDProfileOn      = MFUnset;
+static FILE *_MDProfileTrace  = (FILE *) NULL;
+static int  _MDProfileDay     = 0; // current time step as yyyymmdd
+static pthread_mutex_t _MDProfileMutex = PTHREAD_MUTEX_INITIALIZER;
+
+static const char *_MDProfileNames [MDProfileDepthMax];
+static int _MDProfileDepth = 0;
+
+static long long _MDProfileClock () {
+	struct timespec ts;
+
+	clock_gettime (CLOCK_MONOTONIC, &ts);
+	return ((long long) ts.tv_sec * 1000000000LL + ts.tv_nsec);
+}
+
+static void _MDProfileStepFlush () {
+	int slot;
+
+	for (slot = 0; slot < _MDProfileSlotNum; ++slot) {
+		MDProfileSlot_t *prof = _MDProfileSlots + slot;
+
+		if (prof->StepCalls == 0) continue;
+		if (_MDProfileTrace != (FILE *) NULL)
+			fprintf (_MDProfileTrace, "%d,\"%s\",%lld,%.6f\n", _MDProfileDay, prof->Name, prof->StepCalls, prof->StepNanosecs / 1e9);
+		if (prof->StepCalls > prof->StepMax) prof->StepMax = prof->StepCalls;
+		prof->Steps++;
+		prof->StepCalls    = 0;
+		prof->StepNanosecs = 0;
+	}
+}
+
+static void _MDProfileCall (int slot, int itemID) {
+	MDProfileSlot_t *prof = _MDProfileSlots + slot;
+	int day = MFDateGetCurrentYear () * 10000 + MFDateGetCurrentMonth () * 100 + MFDateGetCurrentDay ();
+	long long start, elapsed;
+
+	if (day != __atomic_load_n (&_MDProfileDay, __ATOMIC_RELAXED)) {
+		pthread_mutex_lock (&_MDProfileMutex);
+		if (day != _MDProfileDay) {
+			_MDProfileStepFlush ();
+			__atomic_store_n (&_MDProfileDay, day, __ATOMIC_RELAXED);
+		}
+		pthread_mutex_unlock (&_MDProfileMutex);
+	}
+	start = _MDProfileClock ();
+	prof->Func (itemID);
+	elapsed = _MDProfileClock () - start;
+	__atomic_fetch_add (&prof->StepCalls,    1,       __ATOMIC_RELAXED);
+	__atomic_fetch_add (&prof->StepNanosecs, elapsed, __ATOMIC_RELAXED);
+	__atomic_fetch_add (&prof->Calls,        1,       __ATOMIC_RELAXED);
+	__atomic_fetch_add (&prof->Nanosecs,     elapsed, __ATOMIC_RELAXED);
+}
+
+// The framework callbacks carry no user data, so each slot gets its own entry point.
+#define MDProfileTramp(g,i) static void _MDProfileTramp##g##_##i (int itemID) { _MDProfileCall (8 * g + i, itemID); }
+#define MDProfileTramp8(g)  MDProfileTramp(g,0) MDProfileTramp(g,1) MDProfileTramp(g,2) MDProfileTramp(g,3) \
+                            MDProfileTramp(g,4) MDProfileTramp(g,5) MDProfileTramp(g,6) MDProfileTramp(g,7)
+#define MDProfileTrampRef8(g) _MDProfileTramp##g##_0, _MDProfileTramp##g##_1, _MDProfileTramp##g##_2, _MDProfileTramp##g##_3, \
+                              _MDProfileTramp##g##_4, _MDProfileTramp##g##_5, _MDProfileTramp##g##_6, _MDProfileTramp##g##_7
+
+MDProfileTramp8(0)  MDProfileTramp8(1)  MDProfileTramp8(2)  MDProfileTramp8(3)
+MDProfileTramp8(4)  MDProfileTramp8(5)  MDProfileTramp8(6)  MDProfileTramp8(7)
+MDProfileTramp8(8)  MDProfileTramp8(9)  MDProfileTramp8(10) MDProfileTramp8(11)
+MDProfileTramp8(12) MDProfileTramp8(13) MDProfileTramp8(14) MDProfileTramp8(15)
+
+static void (*_MDProfileTramps [MDProfileSlotNum]) (int) = {
+	MDProfileTrampRef8(0),  MDProfileTrampRef8(1),  MDProfileTrampRef8(2),  MDProfileTrampRef8(3),
+	MDProfileTrampRef8(4),  MDProfileTrampRef8(5),  MDProfileTrampRef8(6),  MDProfileTrampRef8(7),
+	MDProfileTrampRef8(8),  MDProfileTrampRef8(9),  MDProfileTrampRef8(10), MDProfileTrampRef8(11),
+	MDProfileTrampRef8(12), MDProfileTrampRef8(13), MDProfileTrampRef8(14), MDProfileTrampRef8(15) };
+
+static int _MDProfileCompare (const void *a, const void *b) {
+	const MDProfileSlot_t *profA = *((const MDProfileSlot_t **) a);
+	const MDProfileSlot_t *profB = *((const MDProfileSlot_t **) b);
+
+	return (profA->Nanosecs < profB->Nanosecs ? 1 : (profA->Nanosecs > profB->Nanosecs ? -1 : 0));
+}
+
+static void _MDProfileSummary () {
+	int slot;
+	long long total = 0;
+	MDProfileSlot_t *sorted [MDProfileSlotNum];
+
+	pthread_mutex_lock (&_MDProfileMutex);
+	_MDProfileStepFlush ();
+	if (_MDProfileTrace != (FILE *) NULL) { fclose (_MDProfileTrace); _MDProfileTrace = (FILE *) NULL; }
+	pthread_mutex_unlock (&_MDProfileMutex);
+
+	for (slot = 0; slot < _MDProfileSlotNum; ++slot) {
+		sorted [slot] = _MDProfileSlots + slot;
+		total += _MDProfileSlots [slot].Nanosecs;
+	}
+	qsort (sorted, _MDProfileSlotNum, sizeof (MDProfileSlot_t *), _MDProfileCompare);
+
+	CMmsgPrint (CMmsgInfo, "%-56s %12s %10s %6s %10s %10s %10s\n", "Module", "Calls", "Time [s]", "[%]", "[us/call]", "Cells/step", "Max cells");
+	for (slot = 0; slot < _MDProfileSlotNum; ++slot) {
+		MDProfileSlot_t *prof = sorted [slot];
+
+		CMmsgPrint (CMmsgInfo, "%-56.56s %12lld %10.3f %6.2f %10.3f %10.0f %10lld\n", prof->Name, prof->Calls, prof->Nanosecs / 1e9,
+		            total > 0 ? 100.0 * prof->Nanosecs / total : 0.0,
+		            prof->Calls > 0 ? prof->Nanosecs / 1e3 / prof->Calls : 0.0,
+		            prof->Steps > 0 ? (double) prof->Calls / prof->Steps : 0.0, prof->StepMax);
+	}
+	CMmsgPrint (CMmsgInfo, "%-56s %12s %10.3f\n", "Total", "", total / 1e9);
+}
+
+static int _MDProfileInit () {
+	const char *optStr;
+	const char *traceName;
+
+	_MDProfileOn = MFoff;
+	if ((optStr = MFOptionGet (MDOptConfig_Profile)) != (char *) NULL) {
+		switch (CMoptLookup (MFswitchOptions, optStr, true)) {
+			case MFhelp: MFOptionMessage (MDOptConfig_Profile, optStr, MFswitchOptions); return (CMfailed);
+			case MFon:   _MDProfileOn = MFon; break;
+			case MFoff:  break;
+			default:     MFOptionMessage (MDOptConfig_Profile, optStr, MFswitchOptions); return (CMfailed);
+		}
+	}
+	if (_MDProfileOn != MFon) return (0);
+
+	if ((traceName = MFOptionGet (MDOptConfig_ProfileTrace)) != (char *) NULL) {
+		if ((_MDProfileTrace = fopen (traceName, "w")) == (FILE *) NULL) {
+			CMmsgPrint (CMmsgUsrError, "Profile trace file [%s] opening error in: %s:%d\n", traceName, __FILE__, __LINE__);
+			return (CMfailed);
+		}
+		fprintf (_MDProfileTrace, "Date,Module,Cells,Time\n");
+	}
+	atexit (_MDProfileSummary);
+	return (0);
+}
+
+void MDProfileDefEntering (const char *name) {
+	if (_MDProfileDepth < MDProfileDepthMax) _MDProfileNames [_MDProfileDepth] = name;
+	_MDProfileDepth++;
+	MFDefEntering (name);
+}
+
+void MDProfileDefLeaving (const char *name) {
+	if (_MDProfileDepth > 0) _MDProfileDepth--;
+	MFDefLeaving (name);
+}
+
+int MDProfileAddFunction (void (*func) (int)) {
+	MDProfileSlot_t *prof;
+
+	if ((_MDProfileOn == MFUnset) && (_MDProfileInit () == CMfailed)) return (CMfailed);
+	if (_MDProfileOn != MFon) return (MFModelAddFunction (func));
+
+	if (_MDProfileSlotNum == MDProfileSlotNum) {
+		CMmsgPrint (CMmsgWarning, "Too many model functions, profiling is skipped for the rest in: %s:%d\n", __FILE__, __LINE__);
+		return (MFModelAddFunction (func));
+	}
+	prof = _MDProfileSlots + _MDProfileSlotNum;
+	prof->Func = func;
+	prof->Name = (_MDProfileDepth > 0) && (_MDProfileDepth <= MDProfileDepthMax) ? _MDProfileNames [_MDProfileDepth - 1] : "Unnamed";
+	return (MFModelAddFunction (_MDProfileTramps [_MDProfileSlotNum++]));
+}
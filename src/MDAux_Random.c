@@ -0,0 +1,89 @@
+/******************************************************************************
+
+GHAAS Water Balance/Transport Model
+Global Hydrological Archive and Analysis System
+Copyright 1994-2023, UNH - ASRC/CUNY
+
+MDAux_Random.c
+
+bfekete@gc.cuny.edu
+
+*******************************************************************************/
+
+#include <math.h>
+#include <MF.h>
+#include <MD.h>
+
+// Counter based random numbers (Philox4x32-10, Salmon et al. 2011). Every draw is a pure function of
+// (seed, stream, itemID, year, day, draw index), so the numbers do not depend on the order the cells are
+// visited in or on the number of threads, and there is no generator state to carry between time steps.
+
+#define MDPhiloxM0 0xD2511F53U
+#define MDPhiloxM1 0xCD9E8D57U
+#define MDPhiloxW0 0x9E3779B9U
+#define MDPhiloxW1 0xBB67AE85U
+
+static void _MDPhilox (const unsigned int key [2], const unsigned int ctr [4], unsigned int out [4]) {
+	int round;
+	unsigned int k0 = key [0], k1 = key [1];
+	unsigned int c0 = ctr [0], c1 = ctr [1], c2 = ctr [2], c3 = ctr [3];
+	unsigned long long p0, p1;
+
+	for (round = 0; round < 10; ++round) {
+		p0 = (unsigned long long) MDPhiloxM0 * c0;
+		p1 = (unsigned long long) MDPhiloxM1 * c2;
+		c0 = (unsigned int) (p1 >> 32) ^ c1 ^ k0;
+		c1 = (unsigned int)  p1;
+		c2 = (unsigned int) (p0 >> 32) ^ c3 ^ k1;
+		c3 = (unsigned int)  p0;
+		k0 += MDPhiloxW0;
+		k1 += MDPhiloxW1;
+	}
+	out [0] = c0; out [1] = c1; out [2] = c2; out [3] = c3;
+}
+
+// Uniform deviate in the open (0,1) interval from the top 24 bits
+static float _MDRandomToUniform (unsigned int bits) {
+	return (((float) (bits >> 8) + 0.5f) * (1.0f / 16777216.0f));
+}
+
+void MDRandomUniform (unsigned int seed, int stream, int itemID, int year, int day, int n, float *values) {
+	int i, j;
+	unsigned int key [2], ctr [4], out [4];
+
+	key [0] = seed;
+	key [1] = (unsigned int) stream;
+	ctr [0] = (unsigned int) itemID;
+	ctr [1] = (unsigned int) year;
+	ctr [2] = (unsigned int) day;
+	for (i = 0; i < n; i += 4) {
+		ctr [3] = (unsigned int) (i / 4);
+		_MDPhilox (key, ctr, out);
+		for (j = 0; (j < 4) && (i + j < n); ++j) values [i + j] = _MDRandomToUniform (out [j]);
+	}
+}
+
+// Standard normal deviates by the Box-Muller transform, each counter block gives four
+void MDRandomNormal (unsigned int seed, int stream, int itemID, int year, int day, int n, float *values) {
+	int i, j;
+	unsigned int key [2], ctr [4], out [4];
+	float normal [4];
+	double radius, angle;
+
+	key [0] = seed;
+	key [1] = (unsigned int) stream;
+	ctr [0] = (unsigned int) itemID;
+	ctr [1] = (unsigned int) year;
+	ctr [2] = (unsigned int) day;
+	for (i = 0; i < n; i += 4) {
+		ctr [3] = (unsigned int) (i / 4);
+		_MDPhilox (key, ctr, out);
+		for (j = 0; j < 4; j += 2) {
+			radius = sqrt (-2.0 * log ((double) _MDRandomToUniform (out [j])));
+			angle  = 2.0 * M_PI * (double) _MDRandomToUniform (out [j + 1]);
+			normal [j]     = (float) (radius * cos (angle));
+			normal [j + 1] = (float) (radius * sin (angle));
+		}
+		for (j = 0; (j < 4) && (i + j < n); ++j) values [i + j] = normal [j];
+	}
+}
@@ -14,18 +14,8 @@ bfekete@gc.cuny.edu
 #include <MD.h>
 
 static int _MDInCore_RunoffID     = MFUnset;
-static int _MDInAux_StepCounterID = MFUnset;
 
-static int _MDOutAux_RunoffMeanID     = MFUnset;
-
-static void _MDAux_MeanRunoff (int itemID) {
-	int   tStep      = MFVarGetInt   (_MDInAux_StepCounterID, itemID, 0);
-	float runoff     = MFVarGetFloat (_MDInCore_RunoffID,     itemID, 0.0);
-	float runoffMean = MFVarGetFloat (_MDOutAux_RunoffMeanID, itemID, 0.0);
-
-	runoffMean  = (float) (((double) runoffMean * (double) tStep + runoff) / ((double) (tStep + 1)));
-	MFVarSetFloat (_MDOutAux_RunoffMeanID, itemID, runoffMean);
-}
+static int _MDOutAux_RunoffMeanID = MFUnset;
 
 int MDAux_RunoffMeanDef () {
 	int  optID = MFinput;
@@ -40,10 +30,8 @@ int MDAux_RunoffMeanDef () {
 		case MFhelp:  MFOptionMessage (MDVarCore_RunoffMean, optStr, MFsourceOptions); return (CMfailed);
 		case MFinput: _MDOutAux_RunoffMeanID  = MFVarGetID (MDVarCore_RunoffMean, "mm/d", MFInput, MFState, MFBoundary); break;
 		case MFcalculate:
-			if (((_MDInAux_StepCounterID = MDAux_StepCounterDef()) == CMfailed) ||
-                ((_MDInCore_RunoffID     = MDCore_RunoffDef())     == CMfailed) ||
-                ((_MDOutAux_RunoffMeanID = MFVarGetID (MDVarCore_RunoffMean, "mm/d", MFOutput, MFState, MFInitial)) == CMfailed) ||
-                (MFModelAddFunction(_MDAux_MeanRunoff) == CMfailed)) return (CMfailed);
+			if (((_MDInCore_RunoffID     = MDCore_RunoffDef())     == CMfailed) ||
+                ((_MDOutAux_RunoffMeanID = MDStatisticsDef (_MDInCore_RunoffID, MDVarCore_RunoffMean, "mm/d", MDStatMean, MDVarCore_RunoffMean)) == CMfailed)) return (CMfailed);
 			break;
 	}
 	MFDefLeaving ("Runoff Mean");
@@ -0,0 +1,184 @@
+/******************************************************************************
+
+GHAAS Water Balance/Transport Model
+Global Hydrological Archive and Analysis System
+Copyright 1994-2023, UNH - ASRC/CUNY
+
+MDAux_SpinUp.c
+
+bfekete@gc.cuny.edu
+
+*******************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <pthread.h>
+#include <MF.h>
+#include <MD.h>
+
+// Spin-up controller (SpinUp on). Storage modules pass their end of step storage to MDSpinUpUpdate, which compares
+// the year end storage of every cell with the one a cycle earlier. A cell counts as converged in a cycle when the
+// change is within SpinUpTolerance (relative). Every cell is re-tested each cycle, so a cell drifting again (e.g.
+// a reservoir fed by an extrapolated aquifer upstream) counts as unconverged until it settles. Storages draining as linear reservoirs
+// (groundwater) are extrapolated to their equilibrium (Aitken's delta squared over three consecutive cycles), so slow
+// aquifers need a few cycles instead of tens. After every cycle the unconverged cells are reported (and written to
+// the SpinUpStatus file for the driving script) and equilibrium is declared once the unconverged fraction of every
+// storage is within SpinUpUnconverged, the state files written at the end of the run then start the main run.
+
+#define MDSpinUpTrackMax 8
+#define MDSpinUpRatioMax 0.99 // largest cycle to cycle contraction extrapolated
+
+typedef struct MDSpinUpRecord_s {
+	double Storage [2]; // year end storage one and two cycles back
+	int    Cycles;      // year ends recorded since the last extrapolation
+} MDSpinUpRecord_t;
+
+typedef struct MDSpinUpTrack_s {
+	const char *Name;
+	bool  Extrapolate;
+	MDSpinUpRecord_t *Records;
+	int   RecordNum;
+	int   CellNum, UnconvergedNum, ExtrapolatedNum; // current cycle
+} MDSpinUpTrack_t;
+
+static MDSpinUpTrack_t _MDSpinUpTracks [MDSpinUpTrackMax];
+static int    _MDSpinUpTrackNum    = 0;
+static int    _MDSpinUpOn          = MFUnset;
+static float  _MDSpinUpTolerance   = 0.001;
+static float  _MDSpinUpUnconverged = 0.0;
+static const char *_MDSpinUpStatusFile = (const char *) NULL;
+static int    _MDSpinUpCycle       = 0;
+static bool   _MDSpinUpPending     = false; // year end seen, cycle not reported yet
+static bool   _MDSpinUpEquilibrium = false;
+static pthread_mutex_t _MDSpinUpMutex = PTHREAD_MUTEX_INITIALIZER;
+
+static void _MDSpinUpReport () {
+	int track, equilibrium = true;
+	float fraction;
+	FILE *outFile = (FILE *) NULL;
+	MDSpinUpTrack_t *spinUp;
+
+	_MDSpinUpCycle++;
+	if ((_MDSpinUpStatusFile != (const char *) NULL) && ((outFile = fopen (_MDSpinUpStatusFile, _MDSpinUpCycle == 1 ? "w" : "a")) == (FILE *) NULL))
+		CMmsgPrint (CMmsgUsrError, "Spin-up status file [%s] opening error in: %s:%d\n", _MDSpinUpStatusFile, __FILE__, __LINE__);
+	for (track = 0; track < _MDSpinUpTrackNum; ++track) {
+		spinUp   = _MDSpinUpTracks + track;
+		fraction = spinUp->CellNum > 0 ? (float) spinUp->UnconvergedNum / (float) spinUp->CellNum : 0.0;
+		if (fraction > _MDSpinUpUnconverged) equilibrium = false;
+		CMmsgPrint (CMmsgInfo, "Spin-up cycle %d [%s]: %d of %d cells unconverged, %d extrapolated\n", _MDSpinUpCycle, spinUp->Name, spinUp->UnconvergedNum, spinUp->CellNum, spinUp->ExtrapolatedNum);
+		if (outFile != (FILE *) NULL) fprintf (outFile, "%d\t%s\t%d\t%d\t%d\n", _MDSpinUpCycle, spinUp->Name, spinUp->UnconvergedNum, spinUp->CellNum, spinUp->ExtrapolatedNum);
+		spinUp->CellNum = spinUp->UnconvergedNum = spinUp->ExtrapolatedNum = 0;
+	}
+	if (equilibrium && !_MDSpinUpEquilibrium) CMmsgPrint (CMmsgInfo, "Spin-up equilibrium reached after %d cycles\n", _MDSpinUpCycle);
+	if (outFile != (FILE *) NULL) {
+		fprintf (outFile, "%d\t%s\n", _MDSpinUpCycle, equilibrium ? "equilibrium" : "unconverged");
+		fclose (outFile);
+	}
+	_MDSpinUpEquilibrium = equilibrium;
+	_MDSpinUpPending     = false;
+}
+
+static void _MDSpinUpFlush () {
+	pthread_mutex_lock (&_MDSpinUpMutex);
+	if (_MDSpinUpPending) _MDSpinUpReport ();
+	pthread_mutex_unlock (&_MDSpinUpMutex);
+}
+
+static MDSpinUpRecord_t *_MDSpinUpRecordGet (MDSpinUpTrack_t *spinUp, int itemID) {
+	int recordNum;
+	MDSpinUpRecord_t *records;
+
+	if (itemID < spinUp->RecordNum) return (spinUp->Records + itemID);
+	recordNum = itemID + 1 > 2 * spinUp->RecordNum ? itemID + 1 : 2 * spinUp->RecordNum;
+	if ((records = (MDSpinUpRecord_t *) realloc (spinUp->Records, recordNum * sizeof (MDSpinUpRecord_t))) == (MDSpinUpRecord_t *) NULL) {
+		CMmsgPrint (CMmsgSysError, "Memory allocation error in: %s:%d", __FILE__, __LINE__);
+		return ((MDSpinUpRecord_t *) NULL);
+	}
+	for ( ; spinUp->RecordNum < recordNum; ++spinUp->RecordNum) records [spinUp->RecordNum].Cycles = 0;
+	spinUp->Records = records;
+	return (spinUp->Records + itemID);
+}
+
+// Returns the storage to carry on with, which differs from the one passed only when it was extrapolated.
+float MDSpinUpUpdate (int track, int itemID, float storage) {
+	double change, prevChange, ratio;
+	bool   converged;
+	MDSpinUpTrack_t  *spinUp;
+	MDSpinUpRecord_t *record;
+
+	if (track == MFUnset) return (storage);
+	if (MFDateGetDayOfYear () != MFDateGetYearLength ()) {
+		if (__atomic_load_n (&_MDSpinUpPending, __ATOMIC_RELAXED)) _MDSpinUpFlush ();
+		return (storage);
+	}
+	spinUp = _MDSpinUpTracks + track;
+	pthread_mutex_lock (&_MDSpinUpMutex);
+	_MDSpinUpPending = true;
+	if ((record = _MDSpinUpRecordGet (spinUp, itemID)) == (MDSpinUpRecord_t *) NULL) {
+		pthread_mutex_unlock (&_MDSpinUpMutex);
+		return (storage);
+	}
+	spinUp->CellNum++;
+	change = record->Cycles > 0 ? storage - record->Storage [0] : 0.0;
+	converged = (record->Cycles > 0) && (fabs (change) <= _MDSpinUpTolerance * 0.5 * (fabs (storage) + fabs (record->Storage [0])));
+	if (!converged) {
+		if (spinUp->Extrapolate && (record->Cycles > 1)) {
+			prevChange = record->Storage [0] - record->Storage [1];
+			ratio = change / prevChange;
+			if ((ratio > 0.0) && (ratio < MDSpinUpRatioMax)) {
+				storage += change * ratio / (1.0 - ratio);
+				if (storage < 0.0) storage = 0.0;
+				record->Cycles = 0;
+				spinUp->ExtrapolatedNum++;
+			}
+		}
+		spinUp->UnconvergedNum++;
+	}
+	record->Storage [1] = record->Storage [0];
+	record->Storage [0] = storage;
+	record->Cycles++;
+	pthread_mutex_unlock (&_MDSpinUpMutex);
+	return (storage);
+}
+
+static int _MDSpinUpInit () {
+	float par;
+	const char *optStr;
+
+	_MDSpinUpOn = MFoff;
+	if ((optStr = MFOptionGet (MDOptConfig_SpinUp)) != (char *) NULL) {
+		switch (CMoptLookup (MFswitchOptions, optStr, true)) {
+			case MFon:  _MDSpinUpOn = MFon; break;
+			case MFoff: break;
+			default:    MFOptionMessage (MDOptConfig_SpinUp, optStr, MFswitchOptions); return (CMfailed);
+		}
+	}
+	if (_MDSpinUpOn == MFoff) return (0);
+	if ((optStr = MFOptionGet (MDOptConfig_SpinUpTolerance)) != (char *) NULL)
+		_MDSpinUpTolerance   = sscanf (optStr, "%f", &par) == 1 ? par : _MDSpinUpTolerance;
+	if ((optStr = MFOptionGet (MDOptConfig_SpinUpUnconverged)) != (char *) NULL)
+		_MDSpinUpUnconverged = sscanf (optStr, "%f", &par) == 1 ? par : _MDSpinUpUnconverged;
+	_MDSpinUpStatusFile = MFOptionGet (MDOptConfig_SpinUpStatus);
+	CMmsgPrint (CMmsgInfo, "Spin-up: tolerance %f, unconverged fraction %f\n", _MDSpinUpTolerance, _MDSpinUpUnconverged);
+	atexit (_MDSpinUpFlush);
+	return (0);
+}
+
+// Registers a tracked storage, returns MFUnset when spin-up is off.
+int MDSpinUpDef (const char *name, bool extrapolate) {
+	MDSpinUpTrack_t *spinUp;
+
+	if ((_MDSpinUpOn == MFUnset) && (_MDSpinUpInit () == CMfailed)) return (CMfailed);
+	if (_MDSpinUpOn == MFoff) return (MFUnset);
+	if (_MDSpinUpTrackNum == MDSpinUpTrackMax) {
+		CMmsgPrint (CMmsgAppError, "Too many spin-up storages [%s] in: %s:%d\n", name, __FILE__, __LINE__);
+		return (CMfailed);
+	}
+	spinUp = _MDSpinUpTracks + _MDSpinUpTrackNum;
+	spinUp->Name        = name;
+	spinUp->Extrapolate = extrapolate;
+	spinUp->Records     = (MDSpinUpRecord_t *) NULL;
+	spinUp->RecordNum   = spinUp->CellNum = spinUp->UnconvergedNum = spinUp->ExtrapolatedNum = 0;
+	return (_MDSpinUpTrackNum++);
+}
@@ -0,0 +1,118 @@
+/******************************************************************************
+
+GHAAS Water Balance/Transport Model
+Global Hydrological Archive and Analysis System
+Copyright 1994-2023, UNH - ASRC/CUNY
+
+MDAux_Statistics.c
+
+bfekete@gc.cuny.edu
+
+*******************************************************************************/
+
+#include <stdio.h>
+#include <math.h>
+#include <MF.h>
+#include <MD.h>
+
+// Running statistics of model variables. Every tracked variable keeps its sample count, mean and (when the
+// standard deviation is asked for) sum of squared deviations as double precision state variables and updates
+// them with Welford's method, together with the minimum and maximum, in a single pass per time step. When the
+// mean itself is an input (e.g. DischargeMean from a layer while its spread is calculated) the running mean is kept
+// under a private <meanName>Running state variable, so the input is never overwritten.
+
+#define MDStatisticsTrackMax 8
+#define MDStatisticsNameLen  64
+
+typedef struct MDStatisticsTrack_s {
+	int  InputID;
+	int  CountID;
+	int  M2ID;
+	int  StatIDs [MDStatNum];
+	char MeanName  [MDStatisticsNameLen];
+	char CountName [MDStatisticsNameLen];
+	char M2Name    [MDStatisticsNameLen];
+} MDStatisticsTrack_t;
+
+static MDStatisticsTrack_t _MDStatisticsTracks [MDStatisticsTrackMax];
+static int _MDStatisticsTrackNum = 0;
+
+static void _MDStatistics (int track, int itemID) {
+	MDStatisticsTrack_t *stats = _MDStatisticsTracks + track;
+	int    count = MFVarGetInt   (stats->CountID,               itemID,   0);
+	double value = MFVarGetFloat (stats->InputID,               itemID, 0.0);
+	double mean  = MFVarGetFloat (stats->StatIDs [MDStatMean],  itemID, 0.0);
+	double delta = value - mean;
+	double m2, extreme;
+
+	mean += delta / (double) (count + 1);
+	MFVarSetFloat (stats->StatIDs [MDStatMean], itemID, mean);
+	if (stats->M2ID != MFUnset) {
+		m2 = MFVarGetFloat (stats->M2ID, itemID, 0.0) + delta * (value - mean);
+		MFVarSetFloat (stats->M2ID, itemID, m2);
+		MFVarSetFloat (stats->StatIDs [MDStatStdDev], itemID, count > 0 ? sqrt (m2 / (double) count) : 0.0);
+	}
+	if (stats->StatIDs [MDStatMin] != MFUnset) {
+		extreme = MFVarGetFloat (stats->StatIDs [MDStatMin], itemID, value);
+		MFVarSetFloat (stats->StatIDs [MDStatMin], itemID, (count == 0) || (value < extreme) ? value : extreme);
+	}
+	if (stats->StatIDs [MDStatMax] != MFUnset) {
+		extreme = MFVarGetFloat (stats->StatIDs [MDStatMax], itemID, value);
+		MFVarSetFloat (stats->StatIDs [MDStatMax], itemID, (count == 0) || (value > extreme) ? value : extreme);
+	}
+	MFVarSetInt (stats->CountID, itemID, count + 1);
+}
+
+// The framework callbacks carry no user data, so each tracked variable gets its own entry point.
+#define MDStatisticsTramp(i) static void _MDStatisticsTramp##i (int itemID) { _MDStatistics (i, itemID); }
+MDStatisticsTramp(0) MDStatisticsTramp(1) MDStatisticsTramp(2) MDStatisticsTramp(3)
+MDStatisticsTramp(4) MDStatisticsTramp(5) MDStatisticsTramp(6) MDStatisticsTramp(7)
+
+static void (*_MDStatisticsTramps [MDStatisticsTrackMax]) (int) = {
+	_MDStatisticsTramp0, _MDStatisticsTramp1, _MDStatisticsTramp2, _MDStatisticsTramp3,
+	_MDStatisticsTramp4, _MDStatisticsTramp5, _MDStatisticsTramp6, _MDStatisticsTramp7 };
+
+static MDStatisticsTrack_t *_MDStatisticsTrackGet (int inputID, const char *meanName, const char *unit) {
+	int track, stat;
+	const char *optStr;
+	MDStatisticsTrack_t *stats;
+
+	for (track = 0; track < _MDStatisticsTrackNum; ++track)
+		if (_MDStatisticsTracks [track].InputID == inputID) return (_MDStatisticsTracks + track);
+
+	if (_MDStatisticsTrackNum == MDStatisticsTrackMax) {
+		CMmsgPrint (CMmsgAppError, "Too many variables with statistics [%s] in: %s:%d\n", meanName, __FILE__, __LINE__);
+		return ((MDStatisticsTrack_t *) NULL);
+	}
+	stats = _MDStatisticsTracks + _MDStatisticsTrackNum;
+	stats->InputID = inputID;
+	stats->M2ID    = MFUnset;
+	for (stat = 0; stat < MDStatNum; ++stat) stats->StatIDs [stat] = MFUnset;
+	if (((optStr = MFOptionGet (meanName)) != (char *) NULL) && (CMoptLookup (MFsourceOptions, optStr, true) == MFinput))
+		snprintf (stats->MeanName, sizeof (stats->MeanName), "%sRunning", meanName);
+	else snprintf (stats->MeanName, sizeof (stats->MeanName), "%s", meanName);
+	snprintf (stats->CountName, sizeof (stats->CountName), "%sCount", meanName);
+	snprintf (stats->M2Name,    sizeof (stats->M2Name),    "%sM2",    meanName);
+	if (((stats->CountID               = MFVarGetID (stats->CountName,  MFNoUnit, MFInt,    MFState, MFInitial)) == CMfailed) ||
+	    ((stats->StatIDs [MDStatMean]  = MFVarGetID (stats->MeanName,  (char *) unit, MFDouble, MFState, MFInitial)) == CMfailed) ||
+	    (MFModelAddFunction (_MDStatisticsTramps [_MDStatisticsTrackNum]) == CMfailed)) return ((MDStatisticsTrack_t *) NULL);
+	_MDStatisticsTrackNum++;
+	return (stats);
+}
+
+int MDStatisticsDef (int inputID, const char *meanName, const char *unit, int stat, const char *statName) {
+	MDStatisticsTrack_t *stats;
+
+	if ((stats = _MDStatisticsTrackGet (inputID, meanName, unit)) == (MDStatisticsTrack_t *) NULL) return (CMfailed);
+	if (stats->StatIDs [stat] != MFUnset) return (stats->StatIDs [stat]);
+
+	switch (stat) {
+		case MDStatStdDev:
+			if ((stats->M2ID = MFVarGetID (stats->M2Name, MFNoUnit, MFDouble, MFState, MFInitial)) == CMfailed) return (CMfailed);
+			break;
+		case MDStatMin:
+		case MDStatMax: break;
+		default: return (CMfailed);
+	}
+	return (stats->StatIDs [stat] = MFVarGetID ((char *) statName, (char *) unit, MFOutput, MFState, MFInitial));
+}
@@ -0,0 +1,113 @@
+/******************************************************************************
+
+GHAAS Water Balance/Transport Model
+Global Hydrological Archive and Analysis System
+Copyright 1994-2023, UNH - ASRC/CUNY
+
+MDAux_UpstreamSum.c
+
+bfekete@gc.cuny.edu
+
+*******************************************************************************/
+
+#include <stdlib.h>
+#include <pthread.h>
+#include <MF.h>
+#include <MD.h>
+
+// Upstream sums of static layers. Each field has a function returning the cell's own contribution. Cells are
+// visited in routing order, so on the first visit of a year a cell's upstream neighbours have already pushed
+// their sums into its inflow, the cell adds its own value and pushes the result to its downstream cell.
+// Every later visit in the same year just returns the stored sums. The cell records are referenced from fixed size
+// blocks that never move and a cell's Year is published only once its sums are complete, so those later visits
+// read without locking, the mutex is only taken on the first visit of a year.
+
+#define MDUpstreamBlockSize 4096
+#define MDUpstreamBlockMax  16384
+
+typedef struct MDUpstreamCell_s {
+	int    Year;       // year the sums were accumulated in
+	int    InflowYear; // year of the inflow received from upstream
+	float *Sums;       // own value plus everything upstream
+	float *Inflows;    // sums pushed down from the upstream cells
+} MDUpstreamCell_t;
+
+static float (**_MDUpstreamFuncs) (int) = (float (**) (int)) NULL;
+static int               _MDUpstreamFieldNum = 0;
+static MDUpstreamCell_t **_MDUpstreamCells [MDUpstreamBlockMax]; // cell records in blocks
+static pthread_mutex_t   _MDUpstreamMutex    = PTHREAD_MUTEX_INITIALIZER;
+
+int MDUpstreamSumDef (float (*func) (int)) {
+	int field;
+	float (**funcs) (int);
+
+	for (field = 0; field < _MDUpstreamFieldNum; ++field) // Def functions called repeatedly get the same field
+		if (_MDUpstreamFuncs [field] == func) return (field);
+	if ((funcs = (float (**) (int)) realloc (_MDUpstreamFuncs, (_MDUpstreamFieldNum + 1) * sizeof (float (*) (int)))) == (float (**) (int)) NULL) {
+		CMmsgPrint (CMmsgSysError, "Memory allocation error in: %s:%d", __FILE__, __LINE__);
+		return (CMfailed);
+	}
+	_MDUpstreamFuncs = funcs;
+	_MDUpstreamFuncs [_MDUpstreamFieldNum] = func;
+	return (_MDUpstreamFieldNum++);
+}
+
+// Called with the mutex held.
+static MDUpstreamCell_t *_MDUpstreamCellGet (int itemID) {
+	int block = itemID / MDUpstreamBlockSize;
+	MDUpstreamCell_t *cell, **cells;
+
+	if (block >= MDUpstreamBlockMax) {
+		CMmsgPrint (CMmsgAppError, "Too many items [%d] in: %s:%d\n", itemID, __FILE__, __LINE__);
+		return ((MDUpstreamCell_t *) NULL);
+	}
+	if ((cells = _MDUpstreamCells [block]) == (MDUpstreamCell_t **) NULL) {
+		if ((cells = (MDUpstreamCell_t **) calloc (MDUpstreamBlockSize, sizeof (MDUpstreamCell_t *))) == (MDUpstreamCell_t **) NULL) {
+			CMmsgPrint (CMmsgSysError, "Memory allocation error in: %s:%d", __FILE__, __LINE__);
+			return ((MDUpstreamCell_t *) NULL);
+		}
+		__atomic_store_n (_MDUpstreamCells + block, cells, __ATOMIC_RELEASE);
+	}
+	if ((cell = cells [itemID % MDUpstreamBlockSize]) == (MDUpstreamCell_t *) NULL) {
+		if (((cell = (MDUpstreamCell_t *) malloc (sizeof (MDUpstreamCell_t)))                  == (MDUpstreamCell_t *) NULL) ||
+		    ((cell->Sums = (float *) calloc (2 * _MDUpstreamFieldNum + 1, sizeof (float))) == (float *) NULL)) {
+			CMmsgPrint (CMmsgSysError, "Memory allocation error in: %s:%d", __FILE__, __LINE__);
+			if (cell != (MDUpstreamCell_t *) NULL) free (cell);
+			return ((MDUpstreamCell_t *) NULL);
+		}
+		cell->Inflows    = cell->Sums + _MDUpstreamFieldNum;
+		cell->Year       = cell->InflowYear = MFUnset;
+		__atomic_store_n (cells + itemID % MDUpstreamBlockSize, cell, __ATOMIC_RELEASE);
+	}
+	return (cell);
+}
+
+const float *MDUpstreamSums (int itemID) {
+	int field, downID, year = MFDateGetCurrentYear ();
+	MDUpstreamCell_t *cell, *down, **cells;
+
+	if ((itemID / MDUpstreamBlockSize < MDUpstreamBlockMax) &&
+	    ((cells = __atomic_load_n (_MDUpstreamCells + itemID / MDUpstreamBlockSize, __ATOMIC_ACQUIRE)) != (MDUpstreamCell_t **) NULL) &&
+	    ((cell  = __atomic_load_n (cells + itemID % MDUpstreamBlockSize, __ATOMIC_ACQUIRE)) != (MDUpstreamCell_t *) NULL) &&
+	    (__atomic_load_n (&cell->Year, __ATOMIC_ACQUIRE) == year)) return (cell->Sums);
+
+	pthread_mutex_lock (&_MDUpstreamMutex);
+	if ((cell = _MDUpstreamCellGet (itemID)) == (MDUpstreamCell_t *) NULL) {
+		pthread_mutex_unlock (&_MDUpstreamMutex);
+		return ((const float *) NULL);
+	}
+	if (cell->Year != year) {
+		for (field = 0; field < _MDUpstreamFieldNum; ++field)
+			cell->Sums [field] = (cell->InflowYear == year ? cell->Inflows [field] : 0.0) + _MDUpstreamFuncs [field] (itemID);
+		if (((downID = MFModelGetDownLink (itemID, 0)) >= 0) && (downID != itemID) && ((down = _MDUpstreamCellGet (downID)) != (MDUpstreamCell_t *) NULL)) {
+			if (down->InflowYear != year) {
+				for (field = 0; field < _MDUpstreamFieldNum; ++field) down->Inflows [field] = 0.0;
+				down->InflowYear = year;
+			}
+			for (field = 0; field < _MDUpstreamFieldNum; ++field) down->Inflows [field] += cell->Sums [field];
+		}
+		__atomic_store_n (&cell->Year, year, __ATOMIC_RELEASE);
+	}
+	pthread_mutex_unlock (&_MDUpstreamMutex);
+	return (cell->Sums);
+}
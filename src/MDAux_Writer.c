@@ -0,0 +1,177 @@
+/******************************************************************************
+
+GHAAS Water Balance/Transport Model
+Global Hydrological Archive and Analysis System
+Copyright 1994-2023, UNH - ASRC/CUNY
+
+MDAux_Writer.c
+
+bfekete@gc.cuny.edu
+
+*******************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <MF.h>
+#include <MD.h>
+
+// Asynchronous writer for the files the model writes itself (checkpoints, aggregated outputs). Callers encode a
+// snapshot into a malloc'ed buffer and hand it over with MDWriterSubmit, a dedicated thread writes the buffers in
+// submission order while the next time steps compute. The buffers in flight are bounded by OutputWriterMemory (MB),
+// submitting blocks until the writer catches up, 0 writes synchronously. The queue is flushed at exit. A failed
+// write is sticky: every later MDWriterSubmit and MDWriterFlush returns CMfailed, so callers can report it.
+
+typedef struct MDWriterJob_s {
+	char  *FileName;
+	int    Mode;
+	void  *Buffer;
+	size_t Size;
+	struct MDWriterJob_s *Next;
+} MDWriterJob_t;
+
+static MDWriterJob_t *_MDWriterHead = (MDWriterJob_t *) NULL;
+static MDWriterJob_t *_MDWriterTail = (MDWriterJob_t *) NULL;
+static size_t _MDWriterQueued   = 0; // bytes submitted and not yet written
+static size_t _MDWriterLimit    = 0;
+static int    _MDWriterOn       = MFUnset;
+static int    _MDWriterStatus   = 0;       // CMfailed once any write failed
+static pthread_t       _MDWriterThread;
+static pthread_mutex_t _MDWriterMutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t  _MDWriterCond  = PTHREAD_COND_INITIALIZER; // job queued
+static pthread_cond_t  _MDWriterDone  = PTHREAD_COND_INITIALIZER; // job written
+
+static int _MDWriterWrite (const char *fileName, int mode, const void *buffer, size_t size) {
+	bool written;
+	char *tmpName = (char *) NULL;
+	FILE *outFile;
+
+	if (mode == MDWriterReplace) {
+		if ((tmpName = (char *) malloc (strlen (fileName) + 5)) == (char *) NULL) {
+			CMmsgPrint (CMmsgSysError, "Memory allocation error in: %s:%d", __FILE__, __LINE__);
+			return (CMfailed);
+		}
+		sprintf (tmpName, "%s.tmp", fileName);
+	}
+	if ((outFile = fopen (tmpName != (char *) NULL ? tmpName : fileName, mode == MDWriterReplace ? "wb" : "ab")) == (FILE *) NULL) {
+		CMmsgPrint (CMmsgUsrError, "Output file [%s] opening error in: %s:%d\n", fileName, __FILE__, __LINE__);
+		free (tmpName);
+		return (CMfailed);
+	}
+	written = fwrite (buffer, 1, size, outFile) == size;
+	if ((fclose (outFile) != 0) || !written || ((tmpName != (char *) NULL) && (rename (tmpName, fileName) != 0))) {
+		CMmsgPrint (CMmsgUsrError, "Output file [%s] writing error in: %s:%d\n", fileName, __FILE__, __LINE__);
+		free (tmpName);
+		return (CMfailed);
+	}
+	free (tmpName);
+	return (0);
+}
+
+static void *_MDWriterMain (void *arg) {
+	int ret;
+	MDWriterJob_t *job;
+
+	(void) arg;
+	pthread_mutex_lock (&_MDWriterMutex);
+	for ( ; ; ) {
+		while (_MDWriterHead == (MDWriterJob_t *) NULL) pthread_cond_wait (&_MDWriterCond, &_MDWriterMutex);
+		job = _MDWriterHead;
+		pthread_mutex_unlock (&_MDWriterMutex);
+		ret = _MDWriterWrite (job->FileName, job->Mode, job->Buffer, job->Size);
+		pthread_mutex_lock (&_MDWriterMutex);
+		if (ret == CMfailed) _MDWriterStatus = CMfailed;
+		if ((_MDWriterHead = job->Next) == (MDWriterJob_t *) NULL) _MDWriterTail = (MDWriterJob_t *) NULL;
+		_MDWriterQueued -= job->Size;
+		pthread_cond_broadcast (&_MDWriterDone);
+		free (job->FileName);
+		free (job->Buffer);
+		free (job);
+	}
+	return ((void *) NULL);
+}
+
+// Waits until every submitted buffer is on disk.
+int MDWriterFlush () {
+	int ret;
+
+	pthread_mutex_lock (&_MDWriterMutex);
+	while (_MDWriterHead != (MDWriterJob_t *) NULL) pthread_cond_wait (&_MDWriterDone, &_MDWriterMutex);
+	ret = _MDWriterStatus;
+	pthread_mutex_unlock (&_MDWriterMutex);
+	return (ret);
+}
+
+static void _MDWriterExit () {
+	if (MDWriterFlush () == CMfailed) CMmsgPrint (CMmsgUsrError, "Output writer failed, model written files are incomplete\n");
+}
+
+static int _MDWriterInit () {
+	float par;
+	const char *optStr;
+
+	_MDWriterOn    = MFoff;
+	_MDWriterLimit = (size_t) 256 << 20;
+	if ((optStr = MFOptionGet (MDOptConfig_OutputWriterMemory)) != (char *) NULL) {
+		if ((sscanf (optStr, "%f", &par) != 1) || (par < 0.0)) {
+			CMmsgPrint (CMmsgUsrError, "Invalid output writer memory [%s] in: %s:%d\n", optStr, __FILE__, __LINE__);
+			return (CMfailed);
+		}
+		_MDWriterLimit = (size_t) (par * 1048576.0);
+	}
+	if (_MDWriterLimit == 0) return (0);
+	if (pthread_create (&_MDWriterThread, (pthread_attr_t *) NULL, _MDWriterMain, (void *) NULL) != 0) {
+		CMmsgPrint (CMmsgWarning, "Output writer thread could not be started, writing synchronously\n");
+		return (0);
+	}
+	pthread_detach (_MDWriterThread);
+	_MDWriterOn = MFon;
+	atexit (_MDWriterExit);
+	return (0);
+}
+
+// Takes over the malloc'ed buffer, which is freed once written.
+int MDWriterSubmit (const char *fileName, int mode, void *buffer, size_t size) {
+	int ret;
+	MDWriterJob_t *job;
+
+	pthread_mutex_lock (&_MDWriterMutex);
+	if ((_MDWriterOn == MFUnset) && (_MDWriterInit () == CMfailed)) {
+		pthread_mutex_unlock (&_MDWriterMutex);
+		free (buffer);
+		return (CMfailed);
+	}
+	if (_MDWriterOn == MFoff) {
+		pthread_mutex_unlock (&_MDWriterMutex);
+		ret = _MDWriterWrite (fileName, mode, buffer, size);
+		free (buffer);
+		pthread_mutex_lock (&_MDWriterMutex);
+		if (ret == CMfailed) _MDWriterStatus = CMfailed;
+		ret = _MDWriterStatus;
+		pthread_mutex_unlock (&_MDWriterMutex);
+		return (ret);
+	}
+	if (((job = (MDWriterJob_t *) malloc (sizeof (MDWriterJob_t))) == (MDWriterJob_t *) NULL) ||
+	    ((job->FileName = strdup (fileName)) == (char *) NULL)) {
+		CMmsgPrint (CMmsgSysError, "Memory allocation error in: %s:%d", __FILE__, __LINE__);
+		pthread_mutex_unlock (&_MDWriterMutex);
+		free (job);
+		free (buffer);
+		return (CMfailed);
+	}
+	job->Mode   = mode;
+	job->Buffer = buffer;
+	job->Size   = size;
+	job->Next   = (MDWriterJob_t *) NULL;
+	while ((_MDWriterHead != (MDWriterJob_t *) NULL) && (_MDWriterQueued + size > _MDWriterLimit))
+		pthread_cond_wait (&_MDWriterDone, &_MDWriterMutex);
+	if (_MDWriterTail != (MDWriterJob_t *) NULL) _MDWriterTail->Next = job;
+	else _MDWriterHead = job;
+	_MDWriterTail    = job;
+	_MDWriterQueued += size;
+	ret = _MDWriterStatus;
+	pthread_cond_signal (&_MDWriterCond);
+	pthread_mutex_unlock (&_MDWriterMutex);
+	return (ret);
+}
@@ -19,13 +19,9 @@ static float _MDGrossRadStdTAU = 1.0;
 
 static int _MDOutCommon_GrossRadID = MFUnset;
 
-static void _MDCommon_GrossRadianceStd (int itemID) {
-// Input
-	int   day    = MFDateGetDayOfYear ();
-	float lambda = MFModelGetLatitude (itemID) * DTOR;
-// Output
+static float _MDGrossRadianceStd (float latitude, int day) {
+	float lambda = latitude * DTOR;
 	float  grossRad;
-// Local
 	int   hour;
 	double eta, sigma, sinphi, sp, sbb;
 
@@ -38,16 +34,19 @@ static void _MDCommon_GrossRadianceStd (int itemID) {
 		sbb = sp * sinphi * pow ((double) _MDGrossRadStdTAU,(double) (1.0 / sinphi));
 		if (sbb > 0) grossRad += sbb;
 	}
-	MFVarSetFloat (_MDOutCommon_GrossRadID,  itemID, grossRad / 24.0);
+	return (grossRad / 24.0);
 }
 
-static void _MDCommon_GrossRadianceOtto (int itemID) {
-// Input
-	int   day    = MFDateGetDayOfYear ();
-	float lambda = MFModelGetLatitude (itemID) * DTOR;
+static void _MDCommon_GrossRadianceStd (int itemID) {
 // Output
+	float grossRad = MDSolarGeometryGet (itemID, MDSolarGrossRadStd, _MDGrossRadianceStd); // W/m2
+
+	MFVarSetFloat (_MDOutCommon_GrossRadID,  itemID, grossRad);
+}
+
+static float _MDGrossRadianceOtto (float latitude, int day) {
+	float lambda = latitude * DTOR;
 	float  grossRad; // W/m2
-// Local
 	int   hour;
 	double eta, sigma,sinphi,sp,sbb,sotd;
 
@@ -61,7 +60,14 @@ static void _MDCommon_GrossRadianceOtto (int itemID) {
 		sbb = sp * sinphi / pow (sotd,2.0);
 		if (sbb >= 0) grossRad += sbb;
 	}
-	MFVarSetFloat (_MDOutCommon_GrossRadID,  itemID, grossRad / 24.0);
+	return (grossRad / 24.0);
+}
+
+static void _MDCommon_GrossRadianceOtto (int itemID) {
+// Output
+	float grossRad = MDSolarGeometryGet (itemID, MDSolarGrossRadOtto, _MDGrossRadianceOtto); // W/m2
+
+	MFVarSetFloat (_MDOutCommon_GrossRadID,  itemID, grossRad);
 }
 
 enum { MDhelp, MDinput, MDstandard,  MDOtto }; 
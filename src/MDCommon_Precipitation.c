@@ -47,22 +47,6 @@ static void _MDPrecipFraction (int itemID) {
 	MFVarSetFloat (_MDOutCommon_PrecipitationID, itemID, precipOut);
 }
 
-bool MDEvent (int nSteps,int nEvents,int step) {
-  	bool inv = false;
-	int event;
-	float freq;
-
-	if (nSteps == nEvents) return (true);
-
-	if (nEvents > nSteps / 2) { nEvents = nSteps - nEvents; inv = true; }
-		
-  	freq = (float) nSteps / (float) nEvents;
-	for (event = 0;event < step;++event)
-		if ((int) (rint (event * freq + freq / 2.0)) == step) return (inv ? false : true);
-
-	return (inv ? true : false);
-}
-
 static void _MDPrecipWetDays (int itemID) {
 // Model
 	int day   = MFDateGetCurrentDay ();
@@ -73,7 +57,7 @@ static void _MDPrecipWetDays (int itemID) {
 // Output 
 	float precipOut; 
 
-	precipOut = MDEvent (nDays,wetDays,day) ? precipIn * (float) nDays / (float) wetDays : 0.0;
+	precipOut = MDWetDay (nDays,wetDays,day) ? precipIn * (float) nDays / (float) wetDays : 0.0;
 
 	MFVarSetFloat (_MDOutCommon_PrecipitationID, itemID, precipOut);
 }
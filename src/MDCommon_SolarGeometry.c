@@ -0,0 +1,125 @@
+/******************************************************************************
+
+GHAAS Water Balance/Transport Model
+Global Hydrological Archive and Analysis System
+Copyright 1994-2023, UNH - ASRC/CUNY
+
+MDCommon_SolarGeometry.c
+
+bfekete@gc.cuny.edu
+
+*******************************************************************************/
+
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <MF.h>
+#include <MD.h>
+
+// Solar geometry depends only on latitude and day of year, so each quantity is tabulated once
+// for the whole year per distinct grid latitude and shared by every cell in that latitude row.
+#define MDSolarDoYNum 367
+// The latitude row of each cell is kept in fixed size blocks that never move once published, so lookups
+// of cells already tabulated read them without locking, the mutex is only taken to fill a miss.
+#define MDSolarBlockSize 4096
+#define MDSolarBlockMax  16384
+
+typedef struct MDSolarRow_s {
+	float  Latitude;
+	float *Values [MDSolarQuantityNum];
+} MDSolarRow_t;
+
+static MDSolarRow_t **_MDSolarRows    = (MDSolarRow_t **) NULL; // open addressing hash on latitude
+static int            _MDSolarRowSize = 0;
+static int            _MDSolarRowNum  = 0;
+static MDSolarRow_t **_MDSolarItems [MDSolarBlockMax]; // latitude row of each cell in blocks
+static pthread_mutex_t _MDSolarMutex  = PTHREAD_MUTEX_INITIALIZER;
+
+static unsigned int _MDSolarHash (float latitude) {
+	unsigned int bits;
+
+	memcpy (&bits, &latitude, sizeof (bits));
+	return (bits * 2654435761U);
+}
+
+static int _MDSolarRowInsert (MDSolarRow_t **rows, int size, MDSolarRow_t *row) {
+	unsigned int slot = _MDSolarHash (row->Latitude) & (size - 1);
+
+	while (rows [slot] != (MDSolarRow_t *) NULL) slot = (slot + 1) & (size - 1);
+	rows [slot] = row;
+	return (0);
+}
+
+static MDSolarRow_t *_MDSolarRowGet (float latitude) {
+	int i, size;
+	unsigned int slot;
+	MDSolarRow_t *row, **rows;
+
+	if (_MDSolarRowSize > 0) {
+		for (slot = _MDSolarHash (latitude) & (_MDSolarRowSize - 1); (row = _MDSolarRows [slot]) != (MDSolarRow_t *) NULL; slot = (slot + 1) & (_MDSolarRowSize - 1))
+			if (row->Latitude == latitude) return (row);
+	}
+	if (2 * (_MDSolarRowNum + 1) > _MDSolarRowSize) {
+		size = _MDSolarRowSize > 0 ? 2 * _MDSolarRowSize : 1024;
+		if ((rows = (MDSolarRow_t **) calloc (size, sizeof (MDSolarRow_t *))) == (MDSolarRow_t **) NULL) {
+			CMmsgPrint (CMmsgSysError, "Memory allocation error in: %s:%d", __FILE__, __LINE__);
+			return ((MDSolarRow_t *) NULL);
+		}
+		for (i = 0; i < _MDSolarRowSize; ++i)
+			if (_MDSolarRows [i] != (MDSolarRow_t *) NULL) _MDSolarRowInsert (rows, size, _MDSolarRows [i]);
+		free (_MDSolarRows);
+		_MDSolarRows    = rows;
+		_MDSolarRowSize = size;
+	}
+	if ((row = (MDSolarRow_t *) calloc (1, sizeof (MDSolarRow_t))) == (MDSolarRow_t *) NULL) {
+		CMmsgPrint (CMmsgSysError, "Memory allocation error in: %s:%d", __FILE__, __LINE__);
+		return ((MDSolarRow_t *) NULL);
+	}
+	row->Latitude = latitude;
+	_MDSolarRowInsert (_MDSolarRows, _MDSolarRowSize, row);
+	_MDSolarRowNum++;
+	return (row);
+}
+
+static float *_MDSolarValues (int itemID, int quantity, float (*func) (float, int)) {
+	int doy, block = itemID / MDSolarBlockSize;
+	float *values = (float *) NULL;
+	MDSolarRow_t *row = (MDSolarRow_t *) NULL, **rows;
+
+	if (block >= MDSolarBlockMax) return ((float *) NULL);
+	if (((rows = __atomic_load_n (_MDSolarItems + block, __ATOMIC_ACQUIRE)) != (MDSolarRow_t **) NULL) &&
+	    ((row  = __atomic_load_n (rows + itemID % MDSolarBlockSize, __ATOMIC_ACQUIRE)) != (MDSolarRow_t *) NULL) &&
+	    ((values = __atomic_load_n (row->Values + quantity, __ATOMIC_ACQUIRE)) != (float *) NULL)) return (values);
+
+	pthread_mutex_lock (&_MDSolarMutex);
+	if ((rows = _MDSolarItems [block]) == (MDSolarRow_t **) NULL) {
+		if ((rows = (MDSolarRow_t **) calloc (MDSolarBlockSize, sizeof (MDSolarRow_t *))) == (MDSolarRow_t **) NULL) {
+			CMmsgPrint (CMmsgSysError, "Memory allocation error in: %s:%d", __FILE__, __LINE__);
+			pthread_mutex_unlock (&_MDSolarMutex);
+			return ((float *) NULL);
+		}
+		__atomic_store_n (_MDSolarItems + block, rows, __ATOMIC_RELEASE);
+	}
+	if (((row = rows [itemID % MDSolarBlockSize]) == (MDSolarRow_t *) NULL) &&
+	    ((row = _MDSolarRowGet (MFModelGetLatitude (itemID))) != (MDSolarRow_t *) NULL))
+		__atomic_store_n (rows + itemID % MDSolarBlockSize, row, __ATOMIC_RELEASE);
+	if ((row != (MDSolarRow_t *) NULL) && ((values = row->Values [quantity]) == (float *) NULL)) {
+		if ((values = (float *) malloc (MDSolarDoYNum * sizeof (float))) == (float *) NULL)
+			CMmsgPrint (CMmsgSysError, "Memory allocation error in: %s:%d", __FILE__, __LINE__);
+		else {
+			for (doy = 0; doy < MDSolarDoYNum; ++doy) values [doy] = func (row->Latitude, doy);
+			__atomic_store_n (row->Values + quantity, values, __ATOMIC_RELEASE);
+		}
+	}
+	pthread_mutex_unlock (&_MDSolarMutex);
+	return (values);
+}
+
+float MDSolarGeometryGet (int itemID, int quantity, float (*func) (float, int)) {
+	int doy = MFDateGetDayOfYear ();
+	float *values;
+
+	if ((doy < 0) || (doy >= MDSolarDoYNum) || ((values = _MDSolarValues (itemID, quantity, func)) == (float *) NULL))
+		return (func (MFModelGetLatitude (itemID), doy));
+	return (values [doy]);
+}
@@ -40,22 +40,21 @@ static float _MDSRadH (float lat,int doy,float dec) {
 
 static int _MDOutCommon_SolarRadDayLengthID = MFUnset;
 
-static void _MDCommon_SolarRadDayLength (int itemID) { // daylength fraction of day
-// Model
-	int doy   = MFDateGetDayOfYear (); // day of the year
-	float lat = MFModelGetLatitude (itemID) / 180.0 * M_PI;; // latitude in radians
-
-// Input
-// Output
-	float dayLength;
-// Local
+static float _MDSRadDayLength (float latitude, int doy) { // daylength fraction of day
+	float lat = latitude / 180.0 * M_PI; // latitude in radians
 	float dec;
 
    dec = _MDSRadDEC (doy);
 
    if (fabs ((double) lat) > M_PI_2) lat = (M_PI_2 - (double) 0.01) * (lat > 0.0 ? 1.0 : -1.0);
 
-	dayLength = _MDSRadH (lat,doy,dec) / M_PI;
+	return (_MDSRadH (lat,doy,dec) / M_PI);
+}
+
+static void _MDCommon_SolarRadDayLength (int itemID) { // daylength fraction of day
+// Output
+	float dayLength = MDSolarGeometryGet (itemID, MDSolarDayLength, _MDSRadDayLength);
+
 	MFVarSetFloat (_MDOutCommon_SolarRadDayLengthID,itemID,dayLength);
 }
 
@@ -71,14 +70,8 @@ int MDCommon_SolarRadDayLengthDef () {
 
 static int _MDOutCommon_SolarRadI0HDayID = MFUnset;
 
-static void _MDSRadI0HDay (int itemID) { // daily potential solar radiation from Sellers (1965)
-// Model
-	int   doy = MFDateGetDayOfYear (); // day of the year
-	float lat = MFModelGetLatitude (itemID) / 180.0 * M_PI; // latitude in decimal degrees converted to radian
-// Input
-// Output
-	float i0hDay;
-// Local
+static float _MDSRadI0H (float latitude, int doy) { // daily potential solar radiation from Sellers (1965)
+	float lat = latitude / 180.0 * M_PI; // latitude in decimal degrees converted to radian
 	float isc, dec, h;
 
 	isc = _MDSRadISC (doy);
@@ -87,7 +80,13 @@ static void _MDSRadI0HDay (int itemID) { // daily potential solar radiation from
 	if (fabs ((double) lat) > M_PI_2) lat = (M_PI_2 - (double) 0.01) * (lat > 0.0 ? 1.0 : -1.0);
 	h = _MDSRadH (lat,doy,dec);
 
-	i0hDay =	0.000001 * isc * (86400.0 / M_PI) *  (h * sin(lat) * sin(dec) + cos(lat) * cos(dec) * sin(h));
+	return (0.000001 * isc * (86400.0 / M_PI) *  (h * sin(lat) * sin(dec) + cos(lat) * cos(dec) * sin(h)));
+}
+
+static void _MDSRadI0HDay (int itemID) {
+// Output
+	float i0hDay = MDSolarGeometryGet (itemID, MDSolarI0HDay, _MDSRadI0H);
+
 	MFVarSetFloat (_MDOutCommon_SolarRadI0HDayID,itemID,i0hDay);
 }
 
@@ -40,12 +40,57 @@ static void _MDWetDays (int itemID) {
 
 enum { MDhelp, MDinput, MDlbg };
 
+bool MDEvent (int nSteps,int nEvents,int step) {
+  	bool inv = false;
+	int event;
+	float freq;
+
+	if (nSteps == nEvents) return (true);
+
+	if (nEvents > nSteps / 2) { nEvents = nSteps - nEvents; inv = true; }
+		
+  	freq = (float) nSteps / (float) nEvents;
+	for (event = 0;event < step;++event)
+		if ((int) (rint (event * freq + freq / 2.0)) == step) return (inv ? false : true);
+
+	return (inv ? true : false);
+}
+
+// Wet day schedules are bit masks over the days of the month indexed by month length and wet day count.
+#define MDWetDayScheduleMax 31
+
+static unsigned int _MDWetDaySchedule [MDWetDayScheduleMax + 1][MDWetDayScheduleMax + 1];
+static bool _MDWetDayScheduleReady = false;
+
+void MDWetDayScheduleInit () {
+	int nDays, wetDays, day;
+
+	if (_MDWetDayScheduleReady) return;
+	for (nDays = 0; nDays <= MDWetDayScheduleMax; ++nDays)
+		for (wetDays = 0; wetDays <= MDWetDayScheduleMax; ++wetDays) {
+			_MDWetDaySchedule [nDays][wetDays] = 0;
+			for (day = 0; day <= MDWetDayScheduleMax; ++day)
+				if (MDEvent (nDays, wetDays, day)) _MDWetDaySchedule [nDays][wetDays] |= 1U << day;
+		}
+	_MDWetDayScheduleReady = true;
+}
+
+bool MDWetDay (int nDays, int wetDays, int day) {
+	if (_MDWetDayScheduleReady &&
+	    (nDays   >= 0) && (nDays   <= MDWetDayScheduleMax) &&
+	    (wetDays >= 0) && (wetDays <= MDWetDayScheduleMax) &&
+	    (day     >= 0) && (day     <= MDWetDayScheduleMax))
+		return ((_MDWetDaySchedule [nDays][wetDays] >> day) & 1U ? true : false);
+	return (MDEvent (nDays, wetDays, day));
+}
+
 int MDCommon_WetDaysDef ()
 	{
 	int optID = MDinput;
 	const char *optStr;
 	const char *options [] = { MFhelpStr, MFinputStr, "LBG", (char *) NULL };
 
+	MDWetDayScheduleInit ();
 	if (_MDOutCommon_WetDaysID != MFUnset) return (_MDOutCommon_WetDaysID);
 
 	MFDefEntering ("Wet Days");
@@ -29,8 +29,25 @@ static int _MDOutCore_BaseFlowID             = MFUnset;
 static int _MDOutCore_IrrUptakeGrdWaterID    = MFUnset;
 static int _MDOutCore_Irrigation_UptakeExternalID = MFUnset;
 
+static int _MDSpinUpGrdWatID = MFUnset;
+
 static float _MDGroundWatBETA = 0.016666667;
 
+// Parameter sweep members
+static int   _MDSweepNum = 0;
+static float _MDSweepBETAs [MDSweepMemberMax];
+static int   _MDOutSweepGrdWatIDs   [MDSweepMemberMax];
+static int   _MDOutSweepBaseFlowIDs [MDSweepMemberMax];
+
+// Drains the groundwater storage and returns the base flow
+static float _MDBaseFlowStep (float *grdWater, float beta) {
+	float baseFlow = *grdWater * beta;
+
+	if (*grdWater > baseFlow) *grdWater -= baseFlow;
+	else { baseFlow = *grdWater; *grdWater = 0.0; }
+	return (baseFlow);
+}
+
 static void _MDCore_BaseFlow (int itemID) {
 // Input
 	float grdWaterRecharge;        // Groundwater recharge [mm/dt]
@@ -40,12 +57,16 @@ static void _MDCore_BaseFlow (int itemID) {
 	float baseFlow;                // Base flow from groundwater [mm/dt]
 // Local
 	float grdWater0;
+	float infiltration;
+	float irrInflow = 0.0, irrGrdWatDemand = 0.0; // Irrigation return flow and demand on groundwater for the sweep members
+	float grdWaters [MDSweepMemberMax];
+	int member;
                      
 	grdWater0 = grdWater         = MFVarGetFloat (_MDOutCore_GrdWatID,      itemID, 0.0);
-	grdWater += grdWaterRecharge = MFVarGetFloat (_MDInCore_InfiltrationID, itemID, 0.0);
+	grdWater += grdWaterRecharge = infiltration = MFVarGetFloat (_MDInCore_InfiltrationID, itemID, 0.0);
 
-	if ((_MDInIrrigation_GrossDemandID != MFUnset) &&
-	    (_MDInIrrigation_ReturnFlowID  != MFUnset)) {
+	if (MDIrrigationOn ((_MDInIrrigation_GrossDemandID != MFUnset) &&
+	                    (_MDInIrrigation_ReturnFlowID  != MFUnset))) {
 	// Input
 		float irrDemand     = MFVarGetFloat (_MDInIrrigation_GrossDemandID, itemID, 0.0); // Irrigation demand [mm/dt]
 		float irrReturnFlow = MFVarGetFloat (_MDInIrrigation_ReturnFlowID,  itemID, 0.0); // Irrigational return flow [mm/dt]
@@ -56,8 +77,10 @@ static void _MDCore_BaseFlow (int itemID) {
 
 		grdWater         += irrReturnFlow + irrRunoff;
 		grdWaterRecharge += irrReturnFlow + irrRunoff;
+		irrInflow         = irrReturnFlow + irrRunoff;
 
 		if (_MDOutCore_IrrUptakeGrdWaterID   != MFUnset) {
+			irrGrdWatDemand = irrDemand;
 			if (grdWater > irrDemand) { // Irrigation demand is satisfied from groundwater storage 
 				irrUptakeGrdWater = irrDemand;
 				grdWater -= irrUptakeGrdWater;
@@ -72,14 +95,23 @@ static void _MDCore_BaseFlow (int itemID) {
 		else irrUptakeExt = irrDemand;
 		MFVarSetFloat (_MDOutCore_Irrigation_UptakeExternalID, itemID, irrUptakeExt);
 	}
-	baseFlow = grdWater * _MDGroundWatBETA;
-	if (grdWater > baseFlow) grdWater -= baseFlow;
-	else { baseFlow = grdWater; grdWater = 0.0; }
+	baseFlow = _MDBaseFlowStep (&grdWater, _MDGroundWatBETA);
 
-	MFVarSetFloat (_MDOutCore_GrdWatID,         itemID, grdWater);
+	MFVarSetFloat (_MDOutCore_GrdWatID,         itemID, MDSpinUpUpdate (_MDSpinUpGrdWatID, itemID, grdWater));
     MFVarSetFloat (_MDOutCore_GrdWatChgID,      itemID, grdWater - grdWater0);
     MFVarSetFloat (_MDOutCore_GrdWatRechargeID, itemID, grdWaterRecharge);
 	MFVarSetFloat (_MDOutCore_BaseFlowID,       itemID, baseFlow);
+
+	if (_MDSweepNum == 0) return;
+	for (member = 0; member < _MDSweepNum; ++member) {
+		grdWaters [member]  = MFVarGetFloat (_MDOutSweepGrdWatIDs [member], itemID, 0.0) + infiltration + irrInflow;
+		grdWaters [member] -= grdWaters [member] > irrGrdWatDemand ? irrGrdWatDemand : grdWaters [member];
+	}
+	for (member = 0; member < _MDSweepNum; ++member) {
+		baseFlow = _MDBaseFlowStep (grdWaters + member, _MDSweepBETAs [member]);
+		MFVarSetFloat (_MDOutSweepGrdWatIDs   [member], itemID, grdWaters [member]);
+		MFVarSetFloat (_MDOutSweepBaseFlowIDs [member], itemID, baseFlow);
+	}
 }
 
 int MDCore_BaseFlowDef () {
@@ -93,7 +125,16 @@ int MDCore_BaseFlowDef () {
 		if (strcmp(optStr,MFhelpStr) == 0) CMmsgPrint (CMmsgInfo,"%s = %f", MDParGroundWatBETA, _MDGroundWatBETA);
 		_MDGroundWatBETA = sscanf (optStr,"%f",&par) == 1 ? par : _MDGroundWatBETA;
 	}
-	if (((_MDInCore_InfiltrationID         = MDCore_RainInfiltrationDef ())  == CMfailed) ||
+	if ((_MDSweepNum = MDParameterSweepNum ()) == CMfailed) return (CMfailed);
+	// The members are recharged from the main run's infiltration, which is only right when nothing upstream of the
+	// groundwater differs between members, i.e. BETA is the only swept parameter.
+	if (!MDParameterSweepGet (MDParGroundWatBETA, _MDGroundWatBETA, _MDSweepBETAs)) _MDSweepNum = 0;
+	else if (MDParameterSweepColumnNum () > 1) {
+		CMmsgPrint (CMmsgWarning, "%s is swept with other parameters, groundwater members are skipped\n", MDParGroundWatBETA);
+		_MDSweepNum = 0;
+	}
+	if (((_MDSpinUpGrdWatID = MDSpinUpDef (MDVarCore_GroundWater, true)) == CMfailed) ||
+	    ((_MDInCore_InfiltrationID         = MDCore_RainInfiltrationDef ())  == CMfailed) ||
 		((_NDInRouting_SoilMoistureID      = MDCore_SoilMoistChgDef ())      == CMfailed) ||
 		((_MDInIrrigation_GrossDemandID    = MDIrrigation_GrossDemandDef ()) == CMfailed) ||
 		((_MDInIrrigation_GrossDemandID != MFUnset) &&
@@ -105,6 +146,9 @@ int MDCore_BaseFlowDef () {
         ((_MDOutCore_GrdWatChgID                   = MFVarGetID (MDVarCore_GroundWaterChange,    "mm", MFOutput, MFFlux,  MFBoundary)) == CMfailed)   ||
         ((_MDOutCore_GrdWatRechargeID              = MFVarGetID (MDVarCore_GroundWaterRecharge,  "mm", MFOutput, MFFlux,  MFBoundary)) == CMfailed)   ||
         ((_MDOutCore_BaseFlowID                    = MFVarGetID (MDVarCore_BaseFlow,             "mm", MFOutput, MFFlux,  MFBoundary)) == CMfailed)   ||
+        ((_MDSweepNum > 0) &&
+         ((MDParameterSweepVarDef (MDVarCore_GroundWater, "mm", MFOutput, MFState, MFInitial,  _MDOutSweepGrdWatIDs)   == CMfailed) ||
+          (MDParameterSweepVarDef (MDVarCore_BaseFlow,    "mm", MFOutput, MFFlux,  MFBoundary, _MDOutSweepBaseFlowIDs) == CMfailed))) ||
         (MFModelAddFunction(_MDCore_BaseFlow) == CMfailed)) return (CMfailed);
 	MFDefLeaving ("Base flow ");
 	return (_MDOutCore_BaseFlowID);
@@ -23,7 +23,7 @@ static void _MDEvapotransp (int itemID) {
 // Input
 	float et = MFVarGetFloat (_MDInRainEvapotranspID, itemID, 0.0); // Evapotranspiration [mm/dt]
 	
-	if (_MDInIrrEvapotranspID != MFUnset) et += MFVarGetFloat (_MDInIrrEvapotranspID, itemID, 0.0);
+	if (MDIrrigationOn (_MDInIrrEvapotranspID != MFUnset)) et += MFVarGetFloat (_MDInIrrEvapotranspID, itemID, 0.0);
 	MFVarSetFloat (_MDOutEvapotranspID,  itemID, et);
 }
 
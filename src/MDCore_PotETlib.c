@@ -187,7 +187,7 @@ float MDPETlibGroundResistance (float windSpeed,float height, float z0g,float z0
 	output=((height * exp (MDConstN) / (MDConstN * kh)) *
 		 	(exp (-MDConstN * z0g / height) - exp (-MDConstN * (z0c + dispc) / height)));
    // output=70;
-	if (isinf(output))printf ("ras inf! height %f z0%f, dispc %f kh %f uStar %f za %f\n",height,z0c,dispc,kh,uStar,za);
+	if (isinf(output)) CMmsgPrint (CMmsgDebug,"ras inf! height %f z0%f, dispc %f kh %f uStar %f za %f\n",height,z0c,dispc,kh,uStar,za);
 	//return ((height * exp (MDConstN) / (MDConstN * kh)) *
 		//	 	(exp (-MDConstN * z0g / height) - exp (-MDConstN * (z0c + dispc) / height)));
 	return output;
@@ -271,7 +271,6 @@ float MDPETlibShuttleworthWallace (float rss,float aa,float asubs,float dd,float
    rs = (delta + MDConstPSGAMMA) * ras + MDConstPSGAMMA * rss; 
    rc = (delta + MDConstPSGAMMA) * rac + MDConstPSGAMMA * rsc; 
 	ra = (delta + MDConstPSGAMMA) * raa;
-	printf ("rs %f rc %f ra %f \n",rs,rc,ra);
 	//rs=70;
 	 if (isinf(ra)){
 //		   printf ("ra is INF!!  delta %f MDConstPSGAMMA %f  raa %f\n",delta ,MDConstPSGAMMA, raa);
@@ -74,6 +74,10 @@ static void _MDRainPotETPMdn (int itemID) { // day-night Penman-Monteith PE in m
 
 	if (wSpeed < 0.2) wSpeed = 0.2;
 
+	za   = height + MDConstZMINH; // needed by the nighttime term even without daylight
+	disp = MDPETlibZPDisplacement (height,lai,sai,z0g);
+	z0   = MDPETlibRoughness (disp,height,lai,sai,z0g);
+
  // daytime
 	if (dayLen > 0.0) {
 		solNet  = (1.0 - albedo) * solRad / (MDConstIGRATE * dayLen);
@@ -82,10 +86,6 @@ static void _MDRainPotETPMdn (int itemID) { // day-night Penman-Monteith PE in m
 		uaDtm   = wSpeed / (dayLen + (1.0 - dayLen) * MDConstWNDRAT);
 		lngDtm  = MDSRadNETLong (i0hDay,airTDtm,solRad,vPress);
 
-		za      = height + MDConstZMINH;
-		disp    = MDPETlibZPDisplacement (height,lai,sai,z0g);
-		z0      = MDPETlibRoughness (disp,height,lai,sai,z0g);
-		
 		aa      = solNet + lngDtm - sHeat;
 		es      = MDPETlibVPressSat (airTDtm);
 		delta   = MDPETlibVPressDelta (airTDtm);
@@ -38,7 +38,7 @@ static void _MDRainSMoistChg (int itemID) {
 	float precip       = MFVarGetFloat (_MDInCommon_PrecipID,     itemID, 0.0); // Precipitation [mm/dt]
 	float pet          = MFVarGetFloat (_MDInPotETID,             itemID, 0.0); // Potential evapotranspiration [mm/dt]
 	float snowPackChg  = MFVarGetFloat (_MDInSnowPackChgID,       itemID, 0.0); // Snow pack change [mm/dt]
-	float irrAreaFrac  = _MDInIrrigation_AreaFracID != MFUnset ? MFVarGetFloat (_MDInIrrigation_AreaFracID, itemID, 0.0) : 0.0; // Irrigated area fraction
+	float irrAreaFrac  = MDIrrigationOn (_MDInIrrigation_AreaFracID != MFUnset) ? MFVarGetFloat (_MDInIrrigation_AreaFracID, itemID, 0.0) : 0.0; // Irrigated area fraction
 	float sMoist       = MFVarGetFloat (_MDOutSoilMoistID,        itemID, 0.0); // Soil moisture [mm]
 	float awCap        = MFVarGetFloat (_MDInSoilAvailWaterCapID, itemID, 0.0); // Available water capacity
 	float intercept    = _MDInInterceptID != MFUnset ? MFVarGetFloat (_MDInInterceptID, itemID, 0.0) : 0.0; // Interception (when the interception module is turned on) [mm/dt]
@@ -25,9 +25,35 @@ static int _MDOutSPackChgID       = MFUnset;
 static int _MDOutSnowMeltID       = MFUnset;
 static int _MDOutSnowFallID       = MFUnset;
 
+static int _MDSpinUpSnowPackID    = MFUnset;
+
 static float _MDSnowMeltThreshold =  1.0;
 static float _MDFallThreshold     = -1.0;
 
+// Parameter sweep members
+static int   _MDSweepNum = 0;
+static float _MDSweepMeltThresholds [MDSweepMemberMax];
+static float _MDSweepFallThresholds [MDSweepMemberMax];
+static int   _MDOutSweepSnowPackIDs [MDSweepMemberMax];
+static int   _MDOutSweepSnowMeltIDs [MDSweepMemberMax];
+
+// Updates the snow pack and returns its change
+static float _MDSPackStep (float airT, float precip, float fallThreshold, float meltThreshold, float *sPack, float *sFall, float *sMelt) {
+	*sFall = *sMelt = 0.0;
+	if (airT < fallThreshold) {  /* Accumulating snow pack */
+		*sFall  = precip;
+		*sPack += precip;
+		return (precip);
+	}
+	else if (airT > meltThreshold) { /* Melting snow pack */
+		*sMelt = 2.63 + 2.55 * airT + 0.0912 * airT * precip;
+		*sMelt = *sMelt < *sPack ? *sMelt : *sPack;
+		*sPack = *sPack - *sMelt;
+		return (-*sMelt);
+	}
+	return (0.0); /* No change when air temperature is in [-1.0,1.0] range */
+}
+
 static void _MDSPackChg (int itemID) {
 // Input
 	float airT   = MFVarGetFloat (_MDInCommon_AtMeanID, itemID, 0.0);
@@ -35,27 +61,24 @@ static void _MDSPackChg (int itemID) {
 // Initial
 	float sPack  = MFVarGetFloat (_MDOutSnowPackID,     itemID, 0.0);
 // Output
-	float sMelt = 0.0;
-
-	if (airT < _MDFallThreshold) {  /* Accumulating snow pack */
-		MFVarSetFloat (_MDOutSnowFallID, itemID, precip);
-		MFVarSetFloat (_MDOutSnowMeltID, itemID, 0.0);
-		MFVarSetFloat (_MDOutSnowPackID, itemID, sPack + precip);
-		MFVarSetFloat (_MDOutSPackChgID, itemID, precip);
-	}
-	else if (airT > _MDSnowMeltThreshold) { /* Melting snow pack */
-		sMelt = 2.63 + 2.55 * airT + 0.0912 * airT * precip;
-		sMelt = sMelt < sPack ? sMelt : sPack;
-		MFVarSetFloat (_MDOutSnowFallID, itemID, 0.0);
-		MFVarSetFloat (_MDOutSnowMeltID, itemID,  sMelt);
-		MFVarSetFloat (_MDOutSnowPackID, itemID,  sPack - sMelt);
-		MFVarSetFloat (_MDOutSPackChgID, itemID, -sMelt);
-	}
-	else { /* No change when air temperature is in [-1.0,1.0] range */
-		MFVarSetFloat (_MDOutSnowFallID, itemID, 0.0);
-		MFVarSetFloat (_MDOutSnowMeltID, itemID, 0.0);
-		MFVarSetFloat (_MDOutSnowPackID, itemID, sPack);	
-		MFVarSetFloat (_MDOutSPackChgID, itemID, 0.0);
+	float sFall, sMelt, sPackChg;
+// Local
+	int member;
+	float sPacks [MDSweepMemberMax], sFalls [MDSweepMemberMax], sMelts [MDSweepMemberMax];
+
+	sPackChg = _MDSPackStep (airT, precip, _MDFallThreshold, _MDSnowMeltThreshold, &sPack, &sFall, &sMelt);
+	MFVarSetFloat (_MDOutSnowFallID, itemID, sFall);
+	MFVarSetFloat (_MDOutSnowMeltID, itemID, sMelt);
+	MFVarSetFloat (_MDOutSnowPackID, itemID, MDSpinUpUpdate (_MDSpinUpSnowPackID, itemID, sPack));
+	MFVarSetFloat (_MDOutSPackChgID, itemID, sPackChg);
+
+	if (_MDSweepNum == 0) return;
+	for (member = 0; member < _MDSweepNum; ++member) sPacks [member] = MFVarGetFloat (_MDOutSweepSnowPackIDs [member], itemID, 0.0);
+	for (member = 0; member < _MDSweepNum; ++member)
+		_MDSPackStep (airT, precip, _MDSweepFallThresholds [member], _MDSweepMeltThresholds [member], sPacks + member, sFalls + member, sMelts + member);
+	for (member = 0; member < _MDSweepNum; ++member) {
+		MFVarSetFloat (_MDOutSweepSnowPackIDs [member], itemID, sPacks [member]);
+		MFVarSetFloat (_MDOutSweepSnowMeltIDs [member], itemID, sMelts [member]);
 	}
 }
 
@@ -74,12 +97,18 @@ int MDCore_SnowPackChgDef () {
 		if (strcmp(optStr,MFhelpStr) == 0) CMmsgPrint (CMmsgInfo,"%s = %f", MDParSnowFallThreshold, _MDFallThreshold);
 		_MDFallThreshold = sscanf (optStr,"%f",&par) == 1 ? par : _MDFallThreshold;
 	}
-	if (((_MDInCommon_PrecipID = MDCommon_PrecipitationDef ())  == CMfailed) ||
+	if ((_MDSweepNum = MDParameterSweepNum ()) == CMfailed) return (CMfailed);
+	MDParameterSweepGet (MDParSnowMeltThreshold, _MDSnowMeltThreshold, _MDSweepMeltThresholds);
+	MDParameterSweepGet (MDParSnowFallThreshold, _MDFallThreshold,     _MDSweepFallThresholds);
+	if (((_MDSpinUpSnowPackID  = MDSpinUpDef (MDVarCore_SnowPack, false)) == CMfailed) ||
+	    ((_MDInCommon_PrecipID = MDCommon_PrecipitationDef ())  == CMfailed) ||
         ((_MDInCommon_AtMeanID = MDCommon_AirTemperatureDef ()) == CMfailed) ||
         ((_MDOutSnowFallID     = MFVarGetID (MDVarCommon_SnowFall,     "mm", MFOutput, MFFlux,  MFBoundary)) == CMfailed) ||
         ((_MDOutSnowMeltID     = MFVarGetID (MDVarCore_SnowMelt,       "mm", MFOutput, MFFlux,  MFBoundary)) == CMfailed) ||
         ((_MDOutSnowPackID     = MFVarGetID (MDVarCore_SnowPack,       "mm", MFOutput, MFState, MFInitial))  == CMfailed) ||
         ((_MDOutSPackChgID     = MFVarGetID (MDVarCore_SnowPackChange, "mm", MFOutput, MFFlux,  MFBoundary)) == CMfailed) ||
+        (MDParameterSweepVarDef (MDVarCore_SnowPack, "mm", MFOutput, MFState, MFInitial,  _MDOutSweepSnowPackIDs) == CMfailed) ||
+        (MDParameterSweepVarDef (MDVarCore_SnowMelt, "mm", MFOutput, MFFlux,  MFBoundary, _MDOutSweepSnowMeltIDs) == CMfailed) ||
         (MFModelAddFunction (_MDSPackChg) == CMfailed)) return (CMfailed);
 	MFDefLeaving ("Snow Pack Change");
 	return (_MDOutSPackChgID);
@@ -24,16 +24,18 @@ static int _MDOutSoilMoistID        = MFUnset;
 static int _MDOutSoilMoistChgID     = MFUnset;
 static int _MDOutRelSoilMoistID     = MFUnset;
 
+static int _MDSpinUpSoilMoistID     = MFUnset;
+
 static void _MDSoilMoistChg (int itemID) {	
 // Input
 	float sMoist            = MFVarGetFloat (_MDInRainSoilMoistID,     itemID, 0.0); // Non-irrigated soil moisture [mm/dt]
 	float sMoistChg         = MFVarGetFloat (_MDInRainSoilMoistChgID,  itemID, 0.0); // Non-irrigated soil moisture change [mm/dt]
 	float soilAvailWaterCap = MFVarGetFloat (_MDInSoilAvailWaterCapID, itemID, 0.0); // Available water capacity [mm]
 	
-	if (_MDInIrrSoilMoistID    != MFUnset) sMoist    += MFVarGetFloat (_MDInIrrSoilMoistID,    itemID, 0.0);
-	if (_MDInIrrSoilMoistChgID != MFUnset) sMoistChg += MFVarGetFloat (_MDInIrrSoilMoistChgID, itemID, 0.0);
+	if (MDIrrigationOn (_MDInIrrSoilMoistID    != MFUnset)) sMoist    += MFVarGetFloat (_MDInIrrSoilMoistID,    itemID, 0.0);
+	if (MDIrrigationOn (_MDInIrrSoilMoistChgID != MFUnset)) sMoistChg += MFVarGetFloat (_MDInIrrSoilMoistChgID, itemID, 0.0);
 
-	MFVarSetFloat (_MDOutSoilMoistID,    itemID, sMoist);
+	MFVarSetFloat (_MDOutSoilMoistID,    itemID, MDSpinUpUpdate (_MDSpinUpSoilMoistID, itemID, sMoist));
 	MFVarSetFloat (_MDOutSoilMoistChgID, itemID, sMoistChg);
 	MFVarSetFloat (_MDOutRelSoilMoistID, itemID, CMmathEqualValues (soilAvailWaterCap, 0.0) ? 0.0 : sMoist / soilAvailWaterCap);
 }
@@ -49,7 +51,8 @@ int MDCore_SoilMoistChgDef () {
          ((_MDInIrrSoilMoistID     = MDIrrigation_SoilMoistDef ())    == CMfailed) ||
          ((_MDInIrrSoilMoistChgID  = MDIrrigation_SoilMoistChgDef ()) == CMfailed)))
 	     return (CMfailed);
-	if (((_MDInSoilAvailWaterCapID = MDCore_SoilAvailWaterCapDef())   == CMfailed) ||
+	if (((_MDSpinUpSoilMoistID     = MDSpinUpDef (MDVarCore_SoilMoisture, false)) == CMfailed) ||
+	    ((_MDInSoilAvailWaterCapID = MDCore_SoilAvailWaterCapDef())   == CMfailed) ||
         ((_MDInRainSoilMoistChgID  = MDCore_RainSMoistChgDef ())      == CMfailed) ||
         ((_MDInRainSoilMoistID     = MFVarGetID (MDVarCore_RainSoilMoisture,    "mm", MFInput,  MFState, MFInitial))  == CMfailed) ||
         ((_MDOutSoilMoistID        = MFVarGetID (MDVarCore_SoilMoisture,        "mm", MFOutput, MFState, MFBoundary)) == CMfailed) ||
@@ -51,7 +51,7 @@ static void _MDWaterBalance(int itemID) {
 	float balance;
 
 	balance = precip - evap - runoff - grdWaterChg - snowPackChg - soilMoistChg;
-	if (_MDInIrrigation_GrossDemandID != MFUnset) { 
+	if (MDIrrigationOn (_MDInIrrigation_GrossDemandID != MFUnset)) { 
 	// Input
 		float irrAreaFrac       = MFVarGetFloat (_MDInIrrigation_AreaFracID,       itemID, 0.0);
 		if (irrAreaFrac > 0.0) {
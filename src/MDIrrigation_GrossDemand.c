@@ -30,6 +30,19 @@ typedef struct MDIrrigatedCrop_s {
 
 static MDIrrigatedCrop *_MDirrigCropStruct = (MDIrrigatedCrop *) NULL;
 
+// Per crop parameters used in the daily loop, with Kc and rooting depth tabulated by days since planting
+typedef struct MDIrrigatedCropTable_s {
+    int    *IsRice;
+    int    *DayNum;          // number of tabulated days (length of the growing season)
+    float  *SeasonLength;    // total growing season length
+    float  *RootingDepth;    // maximum rooting depth
+    float  *DepletionFactor;
+    float **KcDays;
+    float **RootingDepthDays;
+} MDIrrigatedCropTable;
+
+static MDIrrigatedCropTable _MDIrrCropTable = { NULL, NULL, NULL, NULL, NULL, NULL, NULL };
+
 //Input
 static int  _MDInIrrigation_AreaFracID  = MFUnset;
 static int *_MDInCropFractionIDs        = (int *) NULL;
@@ -66,10 +79,7 @@ static int _MDIrrDaysSincePlanting (int dayOfYearModel,int numGrowingSeasons, in
 	for (i = 0; i < numGrowingSeasons; ++i) {
 		daysSincePlanted = dayOfYearModel - dayOfYearPlanting [i];
 		if (daysSincePlanted < 0)  daysSincePlanted = 365 + (dayOfYearModel - dayOfYearPlanting [i]);
-		if (daysSincePlanted < _MDirrigCropStruct [crop].cropSeasLength[0]
-		                     + _MDirrigCropStruct [crop].cropSeasLength[1]
-							 + _MDirrigCropStruct [crop].cropSeasLength[2]
-							 + _MDirrigCropStruct [crop].cropSeasLength[3]) ret = daysSincePlanted;
+		if (daysSincePlanted < _MDIrrCropTable.SeasonLength [crop]) ret = daysSincePlanted;
 	}
 	return (ret);
 }
@@ -134,12 +144,61 @@ static float _MDIrrCorrDeplFactor (float cropETP, int crop) {
 	float cropDeplFactor = 0.0;
 
 	if (crop >= _MDNumberOfIrrCrops) return (cropDeplFactor); // Bare soil
-	cropDeplFactor = _MDirrigCropStruct [crop].cropDepletionFactor + 0.04 * (5.0 - cropETP);
+	cropDeplFactor = _MDIrrCropTable.DepletionFactor [crop] + 0.04 * (5.0 - cropETP);
     if (0.1 >= cropDeplFactor) cropDeplFactor = 0.1;
 	if (0.8 <= cropDeplFactor) cropDeplFactor = 0.8;
 	return (cropDeplFactor);
 }
 
+static float _MDIrrCropKcLookup (int daysSincePlanted, int crop) {
+	if ((crop < _MDNumberOfIrrCrops) && (daysSincePlanted >= 0) && (daysSincePlanted < _MDIrrCropTable.DayNum [crop]))
+		return (_MDIrrCropTable.KcDays [crop][daysSincePlanted]);
+	return (_MDIrrCropKc (daysSincePlanted, crop));
+}
+
+static float _MDIrrCropRootingDepthLookup (int daysSincePlanted, int crop) {
+	if ((crop < _MDNumberOfIrrCrops) && (daysSincePlanted >= 0) && (daysSincePlanted < _MDIrrCropTable.DayNum [crop]))
+		return (_MDIrrCropTable.RootingDepthDays [crop][daysSincePlanted]);
+	return (_MDIrrCropRootingDepth (daysSincePlanted, crop));
+}
+
+static int _MDIrrBuildCropTables () {
+	int crop, day, dayNum;
+
+	if (((_MDIrrCropTable.IsRice           = (int *)    calloc (_MDNumberOfIrrCrops + 1, sizeof (int)))     == (int *)    NULL) ||
+	    ((_MDIrrCropTable.DayNum           = (int *)    calloc (_MDNumberOfIrrCrops + 1, sizeof (int)))     == (int *)    NULL) ||
+	    ((_MDIrrCropTable.SeasonLength     = (float *)  calloc (_MDNumberOfIrrCrops + 1, sizeof (float)))   == (float *)  NULL) ||
+	    ((_MDIrrCropTable.RootingDepth     = (float *)  calloc (_MDNumberOfIrrCrops + 1, sizeof (float)))   == (float *)  NULL) ||
+	    ((_MDIrrCropTable.DepletionFactor  = (float *)  calloc (_MDNumberOfIrrCrops + 1, sizeof (float)))   == (float *)  NULL) ||
+	    ((_MDIrrCropTable.KcDays           = (float **) calloc (_MDNumberOfIrrCrops + 1, sizeof (float *))) == (float **) NULL) ||
+	    ((_MDIrrCropTable.RootingDepthDays = (float **) calloc (_MDNumberOfIrrCrops + 1, sizeof (float *))) == (float **) NULL)) {
+		CMmsgPrint (CMmsgSysError, "Memory allocation error in: %s:%d", __FILE__, __LINE__);
+		return (CMfailed);
+	}
+	for (crop = 0; crop < _MDNumberOfIrrCrops; ++crop) {
+		_MDIrrCropTable.IsRice          [crop] = _MDirrigCropStruct [crop].cropIsRice;
+		_MDIrrCropTable.RootingDepth    [crop] = _MDirrigCropStruct [crop].cropRootingDepth;
+		_MDIrrCropTable.DepletionFactor [crop] = _MDirrigCropStruct [crop].cropDepletionFactor;
+		_MDIrrCropTable.SeasonLength    [crop] = _MDirrigCropStruct [crop].cropSeasLength[0]
+		                                       + _MDirrigCropStruct [crop].cropSeasLength[1]
+		                                       + _MDirrigCropStruct [crop].cropSeasLength[2]
+		                                       + _MDirrigCropStruct [crop].cropSeasLength[3];
+		// _MDIrrDaysSincePlanting never returns days beyond the growing season
+		if ((dayNum = _MDIrrCropTable.SeasonLength [crop] > 0.0 ? (int) ceil (_MDIrrCropTable.SeasonLength [crop]) : 0) == 0) continue;
+		if (((_MDIrrCropTable.KcDays           [crop] = (float *) calloc (dayNum, sizeof (float))) == (float *) NULL) ||
+		    ((_MDIrrCropTable.RootingDepthDays [crop] = (float *) calloc (dayNum, sizeof (float))) == (float *) NULL)) {
+			CMmsgPrint (CMmsgSysError, "Memory allocation error in: %s:%d", __FILE__, __LINE__);
+			return (CMfailed);
+		}
+		_MDIrrCropTable.DayNum [crop] = dayNum;
+		for (day = 0; day < dayNum; ++day) {
+			_MDIrrCropTable.KcDays           [crop][day] = _MDIrrCropKc           (day, crop);
+			_MDIrrCropTable.RootingDepthDays [crop][day] = _MDIrrCropRootingDepth (day, crop);
+		}
+	}
+	return (0);
+}
+
 static int _MDIrrReadCropParameters (const char *filename) {
 	FILE *cropFILE;
 	char buffer [512];
@@ -258,8 +317,8 @@ static void _MDIrrGrossDemand (int itemID) {
 				cropFraction [cropID] -= bareSoil;
 				cropFraction [_MDNumberOfIrrCrops] += bareSoil;
 				if (0.0 < cropFraction [cropID]) {
-					cropETP = refETP * _MDIrrCropKc (daysSincePlanted, cropID);
-/* Rice */			if (_MDirrigCropStruct [cropID].cropIsRice == 1) {
+					cropETP = refETP * _MDIrrCropKcLookup (daysSincePlanted, cropID);
+/* Rice */			if (_MDIrrCropTable.IsRice [cropID] == 1) {
 	/* Rainfed */		if (precip >= cropETP + ricePercolation) {
 							cropNetDemand  = cropGrossDemand = 0.0;
 							cropReturnFlow = 0.0;
@@ -272,9 +331,9 @@ static void _MDIrrGrossDemand (int itemID) {
                         cropSMoistChg = 0.0;
 						cropActSMoist = cropSMoist = ricePondingDepth;
 /* Non-rice */		} else {
-						cropMaxRootingDepth  = _MDirrigCropStruct [cropID].cropRootingDepth;
-						cropPrevRootingDepth = _MDIrrCropRootingDepth (daysSincePlanted - 1, cropID);
-						cropCurRootingDepth  = _MDIrrCropRootingDepth (daysSincePlanted, cropID);
+						cropMaxRootingDepth  = _MDIrrCropTable.RootingDepth [cropID];
+						cropPrevRootingDepth = _MDIrrCropRootingDepthLookup (daysSincePlanted - 1, cropID);
+						cropCurRootingDepth  = _MDIrrCropRootingDepthLookup (daysSincePlanted, cropID);
 						cropPrevActSMoist += (cropCurRootingDepth - cropPrevRootingDepth) * (cropPrevSMoist - cropPrevActSMoist) / (cropMaxRootingDepth - cropPrevRootingDepth);
 						cropAvlWater  = (fldCap - wltPnt) * cropCurRootingDepth;
 						cropMinSMoist = cropAvlWater * _MDIrrCorrDeplFactor (cropETP, cropID);
@@ -357,6 +416,14 @@ int MDIrrigation_GrossDemandDef () {
 
 	MFDefEntering ("Irrigation Gross Demand");
 	if ((optStr = MFOptionGet (MDOptConfig_Irrigation)) != (char *) NULL) optID = CMoptLookup (MFcalcOptions,optStr,true);
+#if defined(MDFixedConfig_Irrigation)
+	if ((optID == MFnone) || (optID == MFinput) || (optID == MFcalculate)) {
+		if (optID != (MDFixedConfig_Irrigation == MDFixedNone ? MFnone : (MDFixedConfig_Irrigation == MDFixedInput ? MFinput : MFcalculate))) {
+			CMmsgPrint (CMmsgUsrError, "%s option [%s] does not match the compiled configuration!", MDOptConfig_Irrigation, optStr != (char *) NULL ? optStr : "none");
+			return (CMfailed);
+		}
+	}
+#endif
 	switch (optID) {
 		default:
 		case MFhelp: MFOptionMessage (MDOptConfig_Irrigation, optStr, MFcalcOptions); return (CMfailed);
@@ -390,6 +457,7 @@ int MDIrrigation_GrossDemandDef () {
 				CMmsgPrint(CMmsgUsrError,"Error reading crop parameter file");
 				return (CMfailed);
 			}
+			if (_MDIrrBuildCropTables () == CMfailed) return (CMfailed);
 			for (cropID = 0; cropID < _MDNumberOfIrrCrops; ++cropID) {
 				snprintf (cropFractionName,  sizeof(cropFractionName),  "CropFraction_%s",     _MDirrigCropStruct [cropID].cropName); // Input Fraction of crop type per cell
 				snprintf (cropSMoistName,    sizeof(cropSMoistName),    "CropSoilMoist_%s",    _MDirrigCropStruct [cropID].cropName); // Output Soil Moisture
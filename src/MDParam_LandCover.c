@@ -24,8 +24,8 @@ static void _MDParam_Albedo (int itemID) {
 	int   cover    = MFVarGetInt   (_MDInCommon_CoverID,    itemID,   7); // defaulting missing value to water.
 	float snowPack = MFVarGetFloat (_MDInCommon_SnowPackID, itemID, 0.0);
 // Local
-	static float albedo []     = { 0.14, 0.18, 0.18, 0.20, 0.20, 0.22, 0.26, 0.10 };
-	static float albedoSnow [] = { 0.14, 0.23, 0.35, 0.50, 0.50, 0.50, 0.50, 0.50 };
+	static const float albedo []     = { 0.14, 0.18, 0.18, 0.20, 0.20, 0.22, 0.26, 0.10 };
+	static const float albedoSnow [] = { 0.14, 0.23, 0.35, 0.50, 0.50, 0.50, 0.50, 0.50 };
 	
 	if ((cover < 0) || (cover >= (int) (sizeof (albedo) / sizeof (albedo [0])))) {
 		CMmsgPrint (CMmsgWarning,"Warning: Invalid cover [%d] in: %s:%d\n",cover,__FILE__,__LINE__);
@@ -55,26 +55,55 @@ int MDParam_LCAlbedoDef () {
 			break;
 	}
 	MFDefLeaving ("Albedo");
-	return (_MDOutParam_AlbedoID); 
+	return (_MDOutParam_AlbedoID);
 }
 
-static int _MDOutCParamCHeightID = MFUnset; 
+// Cover only lookup parameters share a single callback so that the cover is read once per cell
+// instead of once per parameter. The Albedo stays separate since it depends on the snow pack too.
+#define MDParam_LCClassNum 8
+#define MDParam_LCLookupMax 16
 
-static void _MDCParamCHeight (int itemID) {
+typedef struct MDParam_LCLookup_s {
+	int          OutID;
+	const float *Lookup;
+} MDParam_LCLookup_t;
+
+static MDParam_LCLookup_t _MDParam_LCLookups [MDParam_LCLookupMax];
+static int _MDParam_LCLookupNum = 0;
+
+static void _MDParam_LCLookup (int itemID) {
 // Input
-	int cover;
+	int cover = MFVarGetInt (_MDInCommon_CoverID, itemID, 7); // defaulting missing value to water.
 // Local
-	static float lookup [] = { 25.0, 25.0, 8.0, 0.5, 0.3, 0.3, 0.1, 0.01}; 
+	int lookupID;
 
-	cover = MFVarGetInt (_MDInCommon_CoverID, itemID, 7); // defaulting missing value to water.
-	if ((cover < 0) || (cover >= (int) (sizeof (lookup) / sizeof (lookup [0])))) {
-		CMmsgPrint (CMmsgWarning ,"Warning: Invalid cover [%d] in: %s:%d\n",cover,__FILE__,__LINE__);
+	if ((cover < 0) || (cover >= MDParam_LCClassNum)) {
+		CMmsgPrint (CMmsgWarning,"Warning: Invalid cover [%d] in: %s:%d\n",cover,__FILE__,__LINE__);
 		return;
 	}
+	for (lookupID = 0; lookupID < _MDParam_LCLookupNum; ++lookupID)
+		MFVarSetFloat (_MDParam_LCLookups [lookupID].OutID, itemID, _MDParam_LCLookups [lookupID].Lookup [cover]);
+}
 
-	MFVarSetFloat (_MDOutCParamCHeightID,itemID, lookup [cover]);	
+static int _MDParam_LCLookupAdd (int outID, const float *lookup) {
+	if (outID == CMfailed) return (CMfailed);
+	if (_MDParam_LCLookupNum >= MDParam_LCLookupMax) {
+		CMmsgPrint (CMmsgAppError,"Too many land cover lookups in: %s:%d\n",__FILE__,__LINE__);
+		return (CMfailed);
+	}
+	if ((_MDParam_LCLookupNum == 0) &&
+	    (((_MDInCommon_CoverID = MDParam_LandCoverMappingDef()) == CMfailed) ||
+	     (MFModelAddFunction (_MDParam_LCLookup) == CMfailed))) return (CMfailed);
+	_MDParam_LCLookups [_MDParam_LCLookupNum].OutID  = outID;
+	_MDParam_LCLookups [_MDParam_LCLookupNum].Lookup = lookup;
+	_MDParam_LCLookupNum++;
+	return (outID);
 }
 
+static int _MDOutCParamCHeightID = MFUnset;
+
+static const float _MDParam_LCHeightLookup [MDParam_LCClassNum] = { 25.0, 25.0, 8.0, 0.5, 0.3, 0.3, 0.1, 0.01};
+
 int MDParam_LCHeightDef ()
 	{
 	int optID = MFinput;
@@ -89,9 +118,7 @@ int MDParam_LCHeightDef ()
 		case MFhelp:   MFOptionMessage (MDVarParam_CHeight, optStr, MFlookupOptions); return (CMfailed);
 		case MFinput:  _MDOutCParamCHeightID = MFVarGetID (MDVarParam_CHeight, "m", MFInput, MFState, MFBoundary); break;
 		case MFlookup:
-			if (((_MDInCommon_CoverID = MDParam_LandCoverMappingDef()) == CMfailed) ||
-                ((_MDOutCParamCHeightID = MFVarGetID (MDVarParam_CHeight, "m", MFOutput, MFState, MFBoundary)) == CMfailed) ||
-                (MFModelAddFunction (_MDCParamCHeight) == CMfailed)) return (CMfailed);
+			if (_MDParam_LCLookupAdd (_MDOutCParamCHeightID = MFVarGetID (MDVarParam_CHeight, "m", MFOutput, MFState, MFBoundary), _MDParam_LCHeightLookup) == CMfailed) return (CMfailed);
 			break;
 	}
 	MFDefLeaving ("Canopy Height");
@@ -100,20 +127,7 @@ int MDParam_LCHeightDef ()
 
 static int _MDOutCParamLWidthID = MFUnset; 
 
-static void _MDCParamLWidth (int itemID) {
-// Input
-	int cover;
-// Local
-	static float lookup [] = { 0.004,0.1,  0.03, 0.01, 0.01, 0.1,  0.02, 0.001};
-
-	cover = MFVarGetInt (_MDInCommon_CoverID, itemID, 7); // defaulting missing value to water.
-	if ((cover < 0) || (cover >= (int) (sizeof (lookup) / sizeof (lookup [0])))) {
-		CMmsgPrint (CMmsgWarning,"Warning: Invalid cover [%d] in: %s:%d\n",cover,__FILE__,__LINE__);
-		return;
-	}
-
-	MFVarSetFloat (_MDOutCParamLWidthID,itemID, lookup [cover]);	
-}
+static const float _MDParam_LCLeafWidthLookup [MDParam_LCClassNum] = { 0.004,0.1,  0.03, 0.01, 0.01, 0.1,  0.02, 0.001};
 
 int MDParam_LCLeafWidthDef () {
 	int optID = MFinput;
@@ -128,9 +142,7 @@ int MDParam_LCLeafWidthDef () {
 		case MFhelp:   MFOptionMessage (MDVarParam_LWidth, optStr, MFlookupOptions); return (CMfailed);
 		case MFinput:  _MDOutCParamLWidthID = MFVarGetID (MDVarParam_LWidth, "mm", MFInput, MFState, MFBoundary); break;
 		case MFlookup:
-			if (((_MDInCommon_CoverID         = MDParam_LandCoverMappingDef()) == CMfailed) ||
-                ((_MDOutCParamLWidthID = MFVarGetID (MDVarParam_LWidth, "mm", MFOutput, MFState, MFBoundary)) == CMfailed) ||
-                (MFModelAddFunction (_MDCParamLWidth) == CMfailed)) return (CMfailed);
+			if (_MDParam_LCLookupAdd (_MDOutCParamLWidthID = MFVarGetID (MDVarParam_LWidth, "mm", MFOutput, MFState, MFBoundary), _MDParam_LCLeafWidthLookup) == CMfailed) return (CMfailed);
 			break;
 	}
 	MFDefLeaving ("Leaf Width");
@@ -139,7 +151,7 @@ int MDParam_LCLeafWidthDef () {
 
 static int _MDOutCParamRSSID = MFUnset; 
 
-static void _MDCParamRSS (int itemID) { MFVarSetFloat (_MDOutCParamRSSID,itemID, MDConstRSS); }
+static const float _MDParam_LCRSSLookup [MDParam_LCClassNum] = { MDConstRSS, MDConstRSS, MDConstRSS, MDConstRSS, MDConstRSS, MDConstRSS, MDConstRSS, MDConstRSS };
 
 int MDParam_LCRSSDef () {
 	int optID = MFinput;
@@ -154,9 +166,7 @@ int MDParam_LCRSSDef () {
 		case MFhelp:   MFOptionMessage (MDVarParam_RSS, optStr, MFlookupOptions); return (CMfailed);
 		case MFinput:  _MDOutCParamRSSID = MFVarGetID (MDVarParam_RSS, "s/m", MFInput, MFState, MFBoundary); break;
 		case MFlookup:
-			if (((_MDInCommon_CoverID = MDParam_LandCoverMappingDef()) == CMfailed) ||
-                ((_MDOutCParamRSSID = MFVarGetID (MDVarParam_RSS, "s/m", MFOutput, MFState, MFBoundary)) == CMfailed) ||
-                (MFModelAddFunction (_MDCParamRSS) == CMfailed)) return (CMfailed);
+			if (_MDParam_LCLookupAdd (_MDOutCParamRSSID = MFVarGetID (MDVarParam_RSS, "s/m", MFOutput, MFState, MFBoundary), _MDParam_LCRSSLookup) == CMfailed) return (CMfailed);
 			break;
 	}
 	MFDefLeaving ("RSS");
@@ -165,20 +175,7 @@ int MDParam_LCRSSDef () {
 
 static int _MDOutCParamR5ID = MFUnset; 
 
-static void _MDCParamR5 (int itemID) {
-// Input
-	int cover;
-// Local
-	static float lookup []     = { 100.0, 100.0, 100.0, 100.0, 100.0, 100.0, 100.0, 10.0 };
-
-	cover = MFVarGetInt (_MDInCommon_CoverID, itemID, 7); // defaulting missing value to water.
-	if ((cover < 0) || (cover >= (int) (sizeof (lookup) / sizeof (lookup [0])))) {
-		CMmsgPrint (CMmsgWarning,"Warning: Invalid cover [%d] in: %s:%d\n",cover,__FILE__,__LINE__);
-		return;
-	}
-
-	MFVarSetFloat (_MDOutCParamR5ID,itemID, lookup [cover]);	
-}
+static const float _MDParam_LCR5Lookup [MDParam_LCClassNum] = { 100.0, 100.0, 100.0, 100.0, 100.0, 100.0, 100.0, 10.0 };
 
 int MDParam_LCR5Def () {
 	int optID = MFinput;
@@ -193,9 +190,7 @@ int MDParam_LCR5Def () {
 		case MFhelp:   MFOptionMessage (MDVarParam_R5, optStr, MFlookupOptions); return (CMfailed);
 		case MFinput:  _MDOutCParamR5ID = MFVarGetID (MDVarParam_R5, "W/m2", MFInput, MFState, MFBoundary); break;
 		case MFlookup:
-			if (((_MDInCommon_CoverID = MDParam_LandCoverMappingDef()) == CMfailed) ||
-                ((_MDOutCParamR5ID = MFVarGetID (MDVarParam_R5, "W/m2", MFOutput, MFState, MFBoundary)) == CMfailed) ||
-                (MFModelAddFunction (_MDCParamR5) == CMfailed)) return (CMfailed);
+			if (_MDParam_LCLookupAdd (_MDOutCParamR5ID = MFVarGetID (MDVarParam_R5, "W/m2", MFOutput, MFState, MFBoundary), _MDParam_LCR5Lookup) == CMfailed) return (CMfailed);
 			break;
 	}
 	MFDefLeaving ("R5");
@@ -204,19 +199,7 @@ int MDParam_LCR5Def () {
 
 static int _MDOutCParamCDID = MFUnset; 
 
-static void _MDCParamCD (int itemID) {
-// Input
-	int cover;
-// Local
-	static float lookup []     = { 2.0, 2.0, 2.0, 2.0, 2.0, 2.0, 2.0, 0.10 };
-
-	cover = MFVarGetInt (_MDInCommon_CoverID, itemID, 7); // defaulting missing value to water.
-	if ((cover < 0) || (cover >= (int) (sizeof (lookup) / sizeof (lookup [0])))) {
-		CMmsgPrint (CMmsgWarning,"Warning: Invalid cover [%d] in: %s:%d\n",cover,__FILE__,__LINE__);
-		return;
-	}
-	MFVarSetFloat (_MDOutCParamCDID,itemID, lookup [cover]);	
-}
+static const float _MDParam_LCCDLookup [MDParam_LCClassNum] = { 2.0, 2.0, 2.0, 2.0, 2.0, 2.0, 2.0, 0.10 };
 
 int MDParam_LCCDDef () {
 	int optID = MFinput;
@@ -231,9 +214,7 @@ int MDParam_LCCDDef () {
 		case MFhelp:   MFOptionMessage (MDVarParam_CD, optStr, MFlookupOptions); return (CMfailed);
 		case MFinput:  _MDOutCParamCDID = MFVarGetID (MDVarParam_CD, "kPa", MFInput, MFState, MFBoundary); break;
 		case MFlookup:
-			if (((_MDInCommon_CoverID = MDParam_LandCoverMappingDef()) == CMfailed) ||
-                ((_MDOutCParamCDID = MFVarGetID (MDVarParam_CD, "kPa", MFOutput, MFState, MFBoundary)) == CMfailed) ||
-                (MFModelAddFunction (_MDCParamCD) == CMfailed)) return (CMfailed);
+			if (_MDParam_LCLookupAdd (_MDOutCParamCDID = MFVarGetID (MDVarParam_CD, "kPa", MFOutput, MFState, MFBoundary), _MDParam_LCCDLookup) == CMfailed) return (CMfailed);
 			break;
 	}
 	MFDefLeaving ("CD");
@@ -242,20 +223,7 @@ int MDParam_LCCDDef () {
 
 static int _MDOutCParamCRID = MFUnset; 
 
-static void _MDCParamCR (int itemID) {
-// Input
-	int cover;
-// Local
-	static float lookup [] = { 0.5, 0.6, 0.6, 0.7, 0.7, 0.7, 0.7, 0.01 };
-
-	cover = MFVarGetInt (_MDInCommon_CoverID, itemID, 7); // defaulting missing value to water.
-	if ((cover < 0) || (cover >= (int) (sizeof (lookup) / sizeof (lookup [0])))) {
-		CMmsgPrint (CMmsgWarning,"Warning: Invalid cover [%d] in: %s:%d\n",cover,__FILE__,__LINE__);
-		return;
-	}
-
-	MFVarSetFloat (_MDOutCParamCRID,itemID, lookup [cover]);	
-}
+static const float _MDParam_LCCRLookup [MDParam_LCClassNum] = { 0.5, 0.6, 0.6, 0.7, 0.7, 0.7, 0.7, 0.01 };
 
 int MDParam_LCCRDef () {
 	int optID = MFinput;
@@ -271,9 +239,7 @@ int MDParam_LCCRDef () {
 		case MFhelp:  MFOptionMessage (MDVarParam_CR, optStr, MFlookupOptions); return (CMfailed);
 		case MFinput:  _MDOutCParamCRID = MFVarGetID (MDVarParam_CR, MFNoUnit, MFInput, MFState, MFBoundary); break;
 		case MFlookup:
-			if (((_MDInCommon_CoverID = MDParam_LandCoverMappingDef()) == CMfailed) ||
-                ((_MDOutCParamCRID = MFVarGetID (MDVarParam_CR, MFNoUnit, MFOutput, MFState, MFBoundary)) == CMfailed) ||
-                (MFModelAddFunction (_MDCParamCR) == CMfailed)) return (CMfailed);
+			if (_MDParam_LCLookupAdd (_MDOutCParamCRID = MFVarGetID (MDVarParam_CR, MFNoUnit, MFOutput, MFState, MFBoundary), _MDParam_LCCRLookup) == CMfailed) return (CMfailed);
 			break;
 	}
 	MFDefLeaving ("CR");
@@ -282,20 +248,7 @@ int MDParam_LCCRDef () {
 
 static int _MDOutCParamGLMaxID = MFUnset; 
 
-static void _MDCParamGLMax (int itemID) {
-// Input
-	int cover;
-// Local
-	static float lookup []     = { 0.0053, 0.0053, 0.0053, 0.008, 0.0066, 0.011, 0.005, 0.001 };
-//in m/s !!!!!!!!!!!!!!
-	cover = MFVarGetInt (_MDInCommon_CoverID, itemID, 7); // defaulting missing value to water.
-	if ((cover < 0) || (cover >= (int) (sizeof (lookup) / sizeof (lookup [0])))) {
-		CMmsgPrint (CMmsgWarning,"Warning: Invalid cover [%d] in: %s:%d\n",cover,__FILE__,__LINE__);
-		return;
-	}
-
-	MFVarSetFloat (_MDOutCParamGLMaxID,itemID, lookup [cover]);	
-}
+static const float _MDParam_LCGLMaxLookup [MDParam_LCClassNum] = { 0.0053, 0.0053, 0.0053, 0.008, 0.0066, 0.011, 0.005, 0.001 }; // in m/s
 
 int MDParam_LCGLMaxDef () {
 	int optID = MFinput;
@@ -311,9 +264,7 @@ int MDParam_LCGLMaxDef () {
 		case MFhelp:   MFOptionMessage (MDVarParam_GLMax, optStr, MFlookupOptions); return (CMfailed);
 		case MFinput:  _MDOutCParamGLMaxID = MFVarGetID (MDVarParam_GLMax, "m/s", MFInput, MFState, MFBoundary); break;
 		case MFlookup:
-			if (((_MDInCommon_CoverID = MDParam_LandCoverMappingDef()) == CMfailed) ||
-                ((_MDOutCParamGLMaxID = MFVarGetID (MDVarParam_GLMax, "m/s", MFOutput, MFState, MFBoundary)) == CMfailed) ||
-                (MFModelAddFunction (_MDCParamGLMax) == CMfailed)) return (CMfailed);
+			if (_MDParam_LCLookupAdd (_MDOutCParamGLMaxID = MFVarGetID (MDVarParam_GLMax, "m/s", MFOutput, MFState, MFBoundary), _MDParam_LCGLMaxLookup) == CMfailed) return (CMfailed);
 			break;
 	}
 	MFDefLeaving ("GLMax");
@@ -322,19 +273,7 @@ int MDParam_LCGLMaxDef () {
 
 static int _MDOutCParamLPMaxID = MFUnset; 
 
-static void _MDCParamLPMax (int itemID) {
-// Input
-	int cover;
-// Local
-	static float lookup []     = { 6, 6, 3, 3, 4, 3, 1, 0.00001 };
-
-	cover = MFVarGetInt (_MDInCommon_CoverID, itemID, 7); // defaulting missing value to water.
-	if ((cover < 0) || (cover >= (int) (sizeof (lookup) / sizeof (lookup [0])))) {
-		CMmsgPrint (CMmsgWarning,"Warning: Invalid cover [%d] in: %s:%d\n",cover,__FILE__,__LINE__);
-		return;
-	}
-	MFVarSetFloat (_MDOutCParamLPMaxID,itemID, lookup [cover]);	
-}
+static const float _MDParam_LCLPMaxLookup [MDParam_LCClassNum] = { 6, 6, 3, 3, 4, 3, 1, 0.00001 };
 
 int MDParam_LCLPMaxDef () {
 	int optID = MFinput;
@@ -349,9 +288,7 @@ int MDParam_LCLPMaxDef () {
 		case MFhelp:   MFOptionMessage (MDVarParam_LPMax, optStr, MFlookupOptions); return (CMfailed);
 		case MFinput:  _MDOutCParamLPMaxID = MFVarGetID (MDVarParam_LPMax, MFNoUnit, MFInput, MFState, false); break;
 		case MFlookup:
-			if (((_MDInCommon_CoverID = MDParam_LandCoverMappingDef()) == CMfailed) ||
-                ((_MDOutCParamLPMaxID = MFVarGetID (MDVarParam_LPMax, MFNoUnit, MFOutput, MFState, false)) == CMfailed) ||
-                (MFModelAddFunction (_MDCParamLPMax) == CMfailed)) return (CMfailed);
+			if (_MDParam_LCLookupAdd (_MDOutCParamLPMaxID = MFVarGetID (MDVarParam_LPMax, MFNoUnit, MFOutput, MFState, false), _MDParam_LCLPMaxLookup) == CMfailed) return (CMfailed);
 			break;
 	}
 	MFDefLeaving ("LPMax");
@@ -360,19 +297,7 @@ int MDParam_LCLPMaxDef () {
 
 static int _MDOutCParamZ0gID = MFUnset; 
 
-static void _MDCParamZ0g (int itemID) {
-// Input
-	int cover;
-// Local
-	static float lookup []     = { 0.02, 0.02, 0.02, 0.01, 0.01, 0.005, 0.001, 0.001 };
-
-	cover = MFVarGetInt (_MDInCommon_CoverID, itemID, 7); // defaulting missing value to water.
-	if ((cover < 0) || (cover >= (int) (sizeof (lookup) / sizeof (lookup [0])))) {
-		CMmsgPrint (CMmsgWarning,"Warning: Invalid cover [%d] in: %s:%d\n",cover,__FILE__,__LINE__);
-		return;
-	}
-	MFVarSetFloat (_MDOutCParamZ0gID,itemID, lookup [cover]);	
-}
+static const float _MDParam_LCZ0gLookup [MDParam_LCClassNum] = { 0.02, 0.02, 0.02, 0.01, 0.01, 0.005, 0.001, 0.001 };
 
 int MDParam_LCZ0gDef () {
 	int optID = MFinput;
@@ -387,9 +312,7 @@ int MDParam_LCZ0gDef () {
 		case MFhelp:   MFOptionMessage (MDVarParam_Z0g, optStr, MFlookupOptions); return (CMfailed);
 		case MFinput:  _MDOutCParamZ0gID = MFVarGetID (MDVarParam_Z0g, "m", MFInput, MFState, false); break;
 		case MFlookup:
-			if (((_MDInCommon_CoverID = MDParam_LandCoverMappingDef()) == CMfailed) ||
-                ((_MDOutCParamZ0gID = MFVarGetID (MDVarParam_Z0g, "m", MFOutput, MFState, false)) == CMfailed) ||
-                (MFModelAddFunction (_MDCParamZ0g) == CMfailed)) return (CMfailed);
+			if (_MDParam_LCLookupAdd (_MDOutCParamZ0gID = MFVarGetID (MDVarParam_Z0g, "m", MFOutput, MFState, false), _MDParam_LCZ0gLookup) == CMfailed) return (CMfailed);
 			break;
 	}
 	MFDefLeaving ("Z0g");
@@ -13,7 +13,9 @@ bfekete@gc.cuny.edu
 
 ******************************************************************************/
 
+#include <stdlib.h>
 #include <math.h>
+#include <pthread.h>
 #include <MF.h>
 #include <MD.h>
 
@@ -46,6 +48,72 @@ static int _MDOutResReleaseBottomID      = MFUnset;
 static int _MDOutResReleaseSpillwayID    = MFUnset;
 static int _MDOutResReleaseTargetID      = MFUnset;
 
+static int _MDSpinUpResStorageID         = MFUnset;
+
+// The SNL operating rule parameters are monthly constants per dam. Reservoir cells keep them in a compact
+// record that is refreshed when the month changes, cells without reservoir never get one. The records are
+// referenced from fixed size blocks that never move, so cells with a record find it without locking.
+#define MDReservoirBlockSize 4096
+#define MDReservoirBlockMax  16384
+
+typedef struct MDReservoirSNL_s {
+	int   Month;              // year * 12 + month the parameters were read for, 0 before the first read
+	float NatFlowMeanMonthly;
+	float StorageRatio;
+	float StorageRatio25;
+	float StorageRatio75;
+	float DemandFactor;
+	float IncMult;
+	float Increment1;
+	float Increment2;
+	float Increment3;
+	float Alpha;
+	float ReleaseAdj;
+} MDReservoirSNL_t;
+
+static MDReservoirSNL_t **_MDReservoirSNLs [MDReservoirBlockMax]; // Parameter record of each item in blocks, NULL for non-reservoir items
+static pthread_mutex_t    _MDReservoirMutex = PTHREAD_MUTEX_INITIALIZER;
+
+static MDReservoirSNL_t *_MDReservoirSNLGet (int itemID) {
+	int month = MFDateGetCurrentYear () * 12 + MFDateGetCurrentMonth (), block = itemID / MDReservoirBlockSize;
+	MDReservoirSNL_t *res = (MDReservoirSNL_t *) NULL, **records;
+
+	if (block >= MDReservoirBlockMax) {
+		CMmsgPrint (CMmsgAppError, "Too many items [%d] in: %s:%d\n", itemID, __FILE__, __LINE__);
+		return ((MDReservoirSNL_t *) NULL);
+	}
+	if (((records = __atomic_load_n (_MDReservoirSNLs + block, __ATOMIC_ACQUIRE)) == (MDReservoirSNL_t **) NULL) ||
+	    ((res = __atomic_load_n (records + itemID % MDReservoirBlockSize, __ATOMIC_ACQUIRE)) == (MDReservoirSNL_t *) NULL)) {
+		pthread_mutex_lock (&_MDReservoirMutex);
+		if (((records = _MDReservoirSNLs [block]) == (MDReservoirSNL_t **) NULL) &&
+		    ((records = (MDReservoirSNL_t **) calloc (MDReservoirBlockSize, sizeof (MDReservoirSNL_t *))) != (MDReservoirSNL_t **) NULL))
+			__atomic_store_n (_MDReservoirSNLs + block, records, __ATOMIC_RELEASE);
+		if ((records != (MDReservoirSNL_t **) NULL) && ((res = records [itemID % MDReservoirBlockSize]) == (MDReservoirSNL_t *) NULL) &&
+		    ((res = (MDReservoirSNL_t *) calloc (1, sizeof (MDReservoirSNL_t))) != (MDReservoirSNL_t *) NULL))
+			__atomic_store_n (records + itemID % MDReservoirBlockSize, res, __ATOMIC_RELEASE);
+		pthread_mutex_unlock (&_MDReservoirMutex);
+		if (res == (MDReservoirSNL_t *) NULL) {
+			CMmsgPrint (CMmsgSysError, "Memory allocation error in: %s:%d", __FILE__, __LINE__);
+			return ((MDReservoirSNL_t *) NULL);
+		}
+	}
+	if (res->Month == month) return (res); // only the thread owning the cell touches its record
+
+	res->NatFlowMeanMonthly = MFVarGetFloat (_MDInResNatFlowMeanMonthlyID, itemID, 0.0);
+	res->StorageRatio       = MFVarGetFloat (_MDInResStorageRatioID,       itemID, 0.0);
+	res->StorageRatio25     = MFVarGetFloat (_MDInResStorageRatio25ID,     itemID, 0.0);
+	res->StorageRatio75     = MFVarGetFloat (_MDInResStorageRatio75ID,     itemID, 0.0);
+	res->DemandFactor       = MFVarGetFloat (_MDInResDemandFactorID,       itemID, 0.0);
+	res->IncMult            = MFVarGetFloat (_MDInResIncMultID,            itemID, 0.0);
+	res->Increment1         = MFVarGetFloat (_MDInResIncrement1ID,         itemID, 0.0);
+	res->Increment2         = MFVarGetFloat (_MDInResIncrement2ID,         itemID, 0.0);
+	res->Increment3         = MFVarGetFloat (_MDInResIncrement3ID,         itemID, 0.0);
+	res->Alpha              = MFVarGetFloat (_MDInResAlphaID,              itemID, 0.0);
+	res->ReleaseAdj         = MFVarGetFloat (_MDInResReleaseAdjID,         itemID, 0.0);
+	res->Month              = month;
+	return (res);
+}
+
 static void _MDReservoirWisser (int itemID) {
 // Input
 	float discharge;             // Current discharge [m3/s]
@@ -93,6 +161,7 @@ static void _MDReservoirWisser (int itemID) {
 		}
 		resStorageChg  = resStorage - prevResStorage;
 		resReleaseExtract = resReleaseBottom + resReleaseSpillway > discharge ? resReleaseBottom + resReleaseSpillway - discharge : 0.0;
+		MDSpinUpUpdate (_MDSpinUpResStorageID, itemID, resStorage); // only reservoir cells count towards equilibrium
 	} else {
 		resStorage = resStorageChg = 0.0;
 		resReleaseBottom   = discharge;
@@ -135,6 +204,7 @@ static void _MDReservoirSNL (int itemID) {
 	resCapacity        = MFVarGetFloat (_MDInResCapacityID,            itemID, 0.0);
 	if (resCapacity > 0.0001) { // TODO Arbitrary limit!!!!
 		// Inputs
+		MDReservoirSNL_t *res;      // monthly constants per dam
 		float demandFactor;         // monthly constant per dam
 		float incMult;              // monthly constant per dam 
 		float increment1;           // monthly constant per dam 
@@ -150,19 +220,20 @@ static void _MDReservoirSNL (int itemID) {
 		float deadStorage = 0.03 * resCapacity;
 		float dt = MFModelGet_dt ();  // Time step length [s]
 		float current_month = MFDateGetCurrentMonth (); // Current Calendar Month
+		if ((res = _MDReservoirSNLGet (itemID)) == (MDReservoirSNL_t *) NULL) return;
 			prevResStorage = MFVarGetFloat (_MDOutResStorageID,           itemID, 0.0);
-		natFlowMeanMonthly = MFVarGetFloat (_MDInResNatFlowMeanMonthlyID, itemID, 0.0);
+		natFlowMeanMonthly = res->NatFlowMeanMonthly;
 		  natFlowMeanDaily = MFVarGetFloat (_MDInResNatFlowMeanDailyID,   itemID, 0.0);
- 	          storageRatio = MFVarGetFloat (_MDInResStorageRatioID,       itemID, 0.0);
-    	     resCapacity25 = MFVarGetFloat (_MDInResStorageRatio25ID,     itemID, 0.0) * resCapacity;
-    	     resCapacity75 = MFVarGetFloat (_MDInResStorageRatio75ID,     itemID, 0.0) * resCapacity;
-    	      demandFactor = MFVarGetFloat (_MDInResDemandFactorID,       itemID, 0.0);
-    	           incMult = MFVarGetFloat (_MDInResIncMultID,            itemID, 0.0);
-    	        increment1 = MFVarGetFloat (_MDInResIncrement1ID,         itemID, 0.0);
-    	        increment2 = MFVarGetFloat (_MDInResIncrement2ID,         itemID, 0.0);
-    	        increment3 = MFVarGetFloat (_MDInResIncrement3ID,         itemID, 0.0);
-    	             alpha = MFVarGetFloat (_MDInResAlphaID,              itemID, 0.0);
-			    releaseAdj = MFVarGetFloat (_MDInResReleaseAdjID,         itemID, 0.0);
+ 	          storageRatio = res->StorageRatio;
+    	     resCapacity25 = res->StorageRatio25 * resCapacity;
+    	     resCapacity75 = res->StorageRatio75 * resCapacity;
+    	      demandFactor = res->DemandFactor;
+    	           incMult = res->IncMult;
+    	        increment1 = res->Increment1;
+    	        increment2 = res->Increment2;
+    	        increment3 = res->Increment3;
+    	             alpha = res->Alpha;
+			    releaseAdj = res->ReleaseAdj;
 		// ARIEL EDITED THIS TO INCULDE "{}" -- not sure it's needed, so please remove if not.
 		if (prevResStorage <= 0.0) {prevResStorage = resCapacity; } // This could only happen before the model updates the initial storage
         
@@ -239,12 +310,13 @@ static void _MDReservoirSNL (int itemID) {
 		}
 		resStorageChg = resStorage - prevResStorage;
 		resReleaseExtract = resReleaseBottom + resReleaseSpillway > discharge ? resReleaseBottom + resReleaseSpillway - discharge : 0.0;
+		MDSpinUpUpdate (_MDSpinUpResStorageID, itemID, resStorage); // only reservoir cells count towards equilibrium
 	} else { // River flow
 		prevResStorage = resStorage = resStorageChg = resReleaseTarget = resReleaseSpillway = 0.0;
 	}
 
 	MFVarSetFloat (_MDOutResStorageInitialID,     itemID, prevResStorage);
-	MFVarSetFloat (_MDOutResStorageID,            itemID, resStorage); 
+	MFVarSetFloat (_MDOutResStorageID,            itemID, resStorage);
 	MFVarSetFloat (_MDOutResStorageChgID,         itemID, resStorageChg); 
 	MFVarSetFloat (_MDOutResInflowID,             itemID, resInflow);
 	MFVarSetFloat (_MDOutResReleaseID,            itemID, resReleaseBottom + resReleaseSpillway);
@@ -263,6 +335,7 @@ int MDReservoir_OperationDef () {
 	if (_MDOutResReleaseID != MFUnset) return (_MDOutResReleaseID);
 
 	MFDefEntering ("Reservoirs");
+	if ((_MDSpinUpResStorageID = MDSpinUpDef (MDVarReservoir_Storage, false)) == CMfailed) return (CMfailed);
 	if ((optStr = MFOptionGet (MDVarReservoir_Release)) != (char *) NULL) optID = CMoptLookup (options, optStr, true);
  	switch (optID) {
 		default:
@@ -39,7 +39,7 @@ static void _MDRouting_DischargeUptake (int itemID) {
 	
 	discharge = MFVarGetFloat (_MDInRouting_DischargeID, itemID, 0.0);
 
-	if (_MDInIrrigation_UptakeExternalID != MFUnset) { // Irrigation is turned on.
+	if (MDIrrigationOn (_MDInIrrigation_UptakeExternalID != MFUnset)) { // Irrigation is turned on.
 		irrUptakeExt = MFVarGetFloat (_MDInIrrigation_UptakeExternalID, itemID, 0.0);
 		if (irrUptakeExt > 0.0) {
 			irrUptakeExt *= MFModelGetArea (itemID) / (MFModelGet_dt () * 1000.0); // converting to m3/s
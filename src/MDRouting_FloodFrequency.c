@@ -0,0 +1,114 @@
+/******************************************************************************
+
+GHAAS Water Balance/Transport Model
+Global Hydrological Archive and Analysis System
+Copyright 1994-2023, UNH - ASRC/CUNY
+
+MDRouting_FloodFrequency.c
+
+bfekete@gc.cuny.edu
+
+*******************************************************************************/
+
+#include <math.h>
+#include <MF.h>
+#include <MD.h>
+
+// Annual flood frequency. MDFloodFrequencyUpdate keeps the running annual maximum of a discharge and, on the
+// last day of the year, folds its logarithm into the one-pass mean, M2 and M3 (T. Terriberry) kept in double
+// precision. MDFloodFrequencyDischarge evaluates the log-Pearson III return period discharge from these
+// moments with frequency factors tabulated once over the skew range.
+
+#define MDFloodSkewMin  -3.0
+#define MDFloodSkewMax   3.0
+#define MDFloodSkewStep  0.01
+#define MDFloodSkewNum   601
+
+static int _MDStateAnnualQMaxID  = MFUnset;
+static int _MDStateYearCountID   = MFUnset;
+static int _MDStateMeanLogQMaxID = MFUnset;
+static int _MDStateLogQMaxM2ID   = MFUnset;
+static int _MDStateLogQMaxM3ID   = MFUnset;
+
+static double _MDFloodKTable [MDFloodPeriodNum][MDFloodSkewNum];
+
+// Polynomial fits of the log-Pearson III frequency factors to the skew coefficient
+static double _MDFloodFrequencyFactor (int period, double skew) {
+	switch (period) {
+		case MDFloodQ2:   return (0.0041*pow(skew,3) - 7e-16*pow(skew,2) - 0.1692*skew + 2e-14);
+		case MDFloodQ5:   return (0.0004*pow(skew,4) + 0.0014*pow(skew,3) - 0.0391*pow(skew,2) - 0.0477*skew + 0.8425);
+		case MDFloodQ10:  return (0.0012*pow(skew,4) - 0.0025*pow(skew,3) - 0.0513*pow(skew,2) + 0.1115*skew + 1.2832);
+		case MDFloodQ25:  return (0.0019*pow(skew,4) - 0.0089*pow(skew,3) - 0.0477*pow(skew,2) + 0.3495*skew + 1.7501);
+		case MDFloodQ50:  return (0.0022*pow(skew,4) - 0.0141*pow(skew,3) - 0.0352*pow(skew,2) + 0.5391*skew + 2.0512);
+		case MDFloodQ100: return (0.0023*pow(skew,4) - 0.0192*pow(skew,3) - 0.0151*pow(skew,2) + 0.7322*skew + 2.3212);
+		case MDFloodQ200: return (0.0020*pow(skew,4) - 0.0243*pow(skew,3) + 0.0115*pow(skew,2) + 0.9272*skew + 2.5679);
+	}
+	return (0.0);
+}
+
+static void _MDFloodKTableInit () {
+	int period, i;
+
+	for (period = 0; period < MDFloodPeriodNum; ++period)
+		for (i = 0; i < MDFloodSkewNum; ++i)
+			_MDFloodKTable [period][i] = _MDFloodFrequencyFactor (period, MDFloodSkewMin + i * MDFloodSkewStep);
+}
+
+static double _MDFloodKLookup (int period, double skew) {
+	int i;
+	double pos;
+
+	if ((skew < MDFloodSkewMin) || (skew > MDFloodSkewMax) || isnan (skew)) return (_MDFloodFrequencyFactor (period, skew));
+	pos = (skew - MDFloodSkewMin) / MDFloodSkewStep;
+	if ((i = (int) pos) >= MDFloodSkewNum - 1) return (_MDFloodKTable [period][MDFloodSkewNum - 1]);
+	pos -= i;
+	return (_MDFloodKTable [period][i] + pos * (_MDFloodKTable [period][i + 1] - _MDFloodKTable [period][i]));
+}
+
+void MDFloodFrequencyUpdate (int itemID, float discharge) {
+	int nA, n;
+	double qMax, logQMax, muA, m2A, m3A, del;
+
+	qMax = MFDateGetDayOfYear () == 1 ? 0.0 : MFVarGetFloat (_MDStateAnnualQMaxID, itemID, 0.0);
+	if (discharge > qMax) qMax = discharge;
+	MFVarSetFloat (_MDStateAnnualQMaxID, itemID, qMax);
+
+	if (MFDateGetDayOfYear () != MFDateGetYearLength ()) return;
+
+	logQMax = qMax > 0.0 ? log10 (qMax) : 0.0;
+	nA  = MFVarGetInt   (_MDStateYearCountID,   itemID, 0);
+	muA = MFVarGetFloat (_MDStateMeanLogQMaxID, itemID, 0.0);
+	m2A = MFVarGetFloat (_MDStateLogQMaxM2ID,   itemID, 0.0);
+	m3A = MFVarGetFloat (_MDStateLogQMaxM3ID,   itemID, 0.0);
+	n   = nA + 1;
+	del = logQMax - muA;
+	MFVarSetInt   (_MDStateYearCountID,   itemID, n);
+	MFVarSetFloat (_MDStateMeanLogQMaxID, itemID, muA + del / n);
+	MFVarSetFloat (_MDStateLogQMaxM2ID,   itemID, m2A + del * del * nA / n);
+	MFVarSetFloat (_MDStateLogQMaxM3ID,   itemID, m3A + del * del * del * nA * (nA - 1) / ((double) n * n) - 3.0 * m2A * del / n);
+}
+
+float MDFloodFrequencyDischarge (int itemID, int period) {
+	int    n    = MFVarGetInt   (_MDStateYearCountID,   itemID, 0);
+	double mean = MFVarGetFloat (_MDStateMeanLogQMaxID, itemID, 0.0);
+	double m2   = MFVarGetFloat (_MDStateLogQMaxM2ID,   itemID, 0.0);
+	double m3   = MFVarGetFloat (_MDStateLogQMaxM3ID,   itemID, 0.0);
+	double stdDev, skew;
+
+	if (n < 1) return (0.0);
+	stdDev = sqrt (m2 / n);
+	skew   = (n > 2) && (stdDev > 0.0) ? (m3 / n) / (stdDev * stdDev * stdDev) : 0.0;
+	return (pow (10.0, mean + _MDFloodKLookup (period, skew) * stdDev));
+}
+
+int MDFloodFrequencyDef () {
+	if (_MDStateYearCountID != MFUnset) return (_MDStateYearCountID);
+
+	_MDFloodKTableInit ();
+	if (((_MDStateAnnualQMaxID  = MFVarGetID (MDVarRouting_AnnualQMax,   "m3/s",   MFDouble, MFState, MFInitial)) == CMfailed) ||
+	    ((_MDStateMeanLogQMaxID = MFVarGetID (MDVarRouting_MeanLogQMax,  MFNoUnit, MFDouble, MFState, MFInitial)) == CMfailed) ||
+	    ((_MDStateLogQMaxM2ID   = MFVarGetID (MDVarRouting_LogQMaxM2,    MFNoUnit, MFDouble, MFState, MFInitial)) == CMfailed) ||
+	    ((_MDStateLogQMaxM3ID   = MFVarGetID (MDVarRouting_LogQMaxM3,    MFNoUnit, MFDouble, MFState, MFInitial)) == CMfailed) ||
+	    ((_MDStateYearCountID   = MFVarGetID (MDVarAux_YearCount,        "yr",     MFInt,    MFState, MFInitial)) == CMfailed)) return (CMfailed);
+	return (_MDStateYearCountID);
+}
@@ -31,25 +31,45 @@ static int _MDOutLithologyMeanID     = MFUnset;
 static int _MDOutPopulationAreaAccID = MFUnset;
 static int _MDOutPopulationDensityID = MFUnset;
 
+// Upstream sums of the static layers
+static int _MDAreaAccField           = MFUnset;
+static int _MDPixelAccField          = MFUnset;
+static int _MDLithologyAreaAccField  = MFUnset;
+static int _MDPopulationAreaAccField = MFUnset;
+
+static float _MDBQARTArea (int itemID) { return (MFModelGetArea (itemID)); }
+
+static float _MDBQARTPixel (int itemID) { (void) itemID; return (1.0); }
+
+static float _MDBQARTLithologyArea (int itemID) {
+	return ((MFVarGetFloat (_MDInBQART_LithologyID, itemID, 0.0)) * (MFModelGetArea (itemID))); //the lithology factor times the area of the pixel
+}
+
+static float _MDBQARTPopulationArea (int itemID) {
+	return (MFVarGetFloat (_MDInPopulationID, itemID, 0.0) * MFModelGetArea (itemID));
+}
+
 static void _MDBQARTinputs (int itemID) {
 
 	float upStreamArea;
 	int AccPixels;
 	float meanLithology,upLithologyArea ;
 	float PopulationAreaAcc,PopuDesity;
+	const float *upSums;
 
+	if ((upSums = MDUpstreamSums (itemID)) == (const float *) NULL) return;
 //Calculating accumulating area	
-	upStreamArea = MFVarGetFloat (_MDInContributingAreaID, itemID, 0.0) + (MFModelGetArea (itemID));//(pow(1000,2)));// convert from m2 to km2  
-	AccPixels = MFVarGetInt (_MDOutNumPixelsID, itemID, 0.0) + 1; //Accumulative pixels
+	upStreamArea = upSums [_MDAreaAccField];
+	AccPixels = (int) upSums [_MDPixelAccField]; //Accumulative pixels
 // Accumulating pixelArea*Lithology factor
-	upLithologyArea =  MFVarGetFloat(_MDOutLithologyAreaAccID, itemID, 0.0) + (MFVarGetFloat (_MDInBQART_LithologyID, itemID, 0.0))*(MFModelGetArea (itemID)); //the lithology factor times the area of the pixel
+	upLithologyArea = upSums [_MDLithologyAreaAccField];
 	meanLithology = upLithologyArea/upStreamArea/AccPixels;	//mean lithology
 	
 	MFVarSetFloat (_MDOutLithologyAreaAccID, itemID, upLithologyArea);
 	MFVarSetFloat (_MDOutLithologyMeanID, itemID, meanLithology);
 
 // Calculating mean population density
-	PopulationAreaAcc = MFVarGetFloat(_MDOutPopulationAreaAccID, itemID, 0.0) + (MFVarGetFloat(_MDInPopulationID, itemID, 0.0)*MFModelGetArea (itemID));
+	PopulationAreaAcc = upSums [_MDPopulationAreaAccField];
 	MFVarSetFloat (_MDOutPopulationAreaAccID, itemID, PopulationAreaAcc);
 	PopuDesity = PopulationAreaAcc/upStreamArea/AccPixels;
 	MFVarSetFloat (_MDOutPopulationDensityID, itemID, PopuDesity);
@@ -69,12 +89,16 @@ int MDSediment_BQARTinputsDef() {
 	    ((_MDInBQART_LithologyID    = MFVarGetID (MDVarSediment_BQART_Lithology,   MFNoUnit, MFInput,  MFState, MFBoundary)) == CMfailed) ||
 	    ((_MDInPopulationID         = MFVarGetID (MDVarSediment_Population,        MFNoUnit, MFInput,  MFState, MFBoundary)) == CMfailed) ||
 	    ((_MDInBQART_GNPID          = MFVarGetID (MDVarSediment_BQART_GNP,         MFNoUnit, MFInput,  MFState, MFBoundary)) == CMfailed) ||
-	    ((_MDInContributingAreaID   = MFVarGetID (MDVarSediment_ContributingArea,  "km2", 	 MFRoute,  MFState, MFBoundary)) == CMfailed) ||
-	    ((_MDOutPopulationAreaAccID = MFVarGetID (MDVarSediment_PopulationAcc,     "",       MFRoute,  MFState, MFBoundary)) == CMfailed) ||
-	    ((_MDOutNumPixelsID         = MFVarGetID (MDVarSediment_NumPixels,         "",       MFRoute,  MFState, MFBoundary)) == CMfailed) ||
-	    ((_MDOutLithologyAreaAccID  = MFVarGetID (MDVarSediment_LithologyAreaAcc,  "" ,      MFRoute,  MFState, MFBoundary)) == CMfailed) ||
+	    ((_MDInContributingAreaID   = MFVarGetID (MDVarSediment_ContributingArea,  "km2", 	 MFOutput,  MFState, MFBoundary)) == CMfailed) ||
+	    ((_MDOutPopulationAreaAccID = MFVarGetID (MDVarSediment_PopulationAcc,     "",       MFOutput,  MFState, MFBoundary)) == CMfailed) ||
+	    ((_MDOutNumPixelsID         = MFVarGetID (MDVarSediment_NumPixels,         "",       MFOutput,  MFState, MFBoundary)) == CMfailed) ||
+	    ((_MDOutLithologyAreaAccID  = MFVarGetID (MDVarSediment_LithologyAreaAcc,  "" ,      MFOutput,  MFState, MFBoundary)) == CMfailed) ||
 	    ((_MDOutLithologyMeanID  	= MFVarGetID (MDVarSediment_LithologyMean,	   "" ,      MFOutput, MFState, MFBoundary)) == CMfailed) ||
 	    ((_MDOutPopulationDensityID = MFVarGetID (MDVarSediment_PopulationDensity, "km2",    MFOutput, MFState, MFBoundary)) == CMfailed) ||
+	    ((_MDAreaAccField           = MDUpstreamSumDef (_MDBQARTArea))           == CMfailed) ||
+	    ((_MDPixelAccField          = MDUpstreamSumDef (_MDBQARTPixel))          == CMfailed) ||
+	    ((_MDLithologyAreaAccField  = MDUpstreamSumDef (_MDBQARTLithologyArea))  == CMfailed) ||
+	    ((_MDPopulationAreaAccField = MDUpstreamSumDef (_MDBQARTPopulationArea)) == CMfailed) ||
        (MFModelAddFunction (_MDBQARTinputs) == CMfailed)) return (CMfailed);
 
 	MFDefLeaving  ("BQARTinputsBQARTinputs");
@@ -31,6 +31,7 @@ static int _MDInAirTempAcc_timeID = MFUnset;
 static int _MDInTimeStepsID 	   = MFUnset;
 static int _MDInContributingAreaAccID = MFUnset;
 static int _MDInBankfullQ5ID =    MFUnset;
+static int _MDInYearCountID  =    MFUnset;
 
 // Output
 static int _MDOutBQART_Qbar_m3sID 	= MFUnset;
@@ -39,70 +40,30 @@ static int _MDOutBQART_TID 	= MFUnset;
 static int _MDOutBQART_AID 	= MFUnset;
 static int _MDOutBQART_RID 	= MFUnset;
 
-static int _MDOutDischMaxID = MFUnset;
-static int _MDOutYearCountID = MFUnset;
-static int _MDOutLogQMaxM2ID = MFUnset;
-static int _MDOutLogQMaxM3ID = MFUnset;
-static int _MDOutMeanLogQMaxID = MFUnset;
+static int _MDAreaAccField = MFUnset;
+
+static float _MDQBARTArea (int itemID) {
+	return (MFModelGetArea (itemID) / (pow (1000,2))); // convert from m2 to km2
+}
 
 // use global arrays rather than static local vars in function 
 
 static void _MDQBARTpreprocess (int itemID) {
 	int TimeStep;
 	float Qday, Qbar,Qacc, Qbar_km3y,Qbar_m3s;
-    float Qmax = 0;
 	float Tday,Tbar,Tacc,A,T_time,T_old;
 	float TupSlop,PixSize_km2;
-
-    int n, nA; 
-    float mu, muA, M2, M2A, M3, M3A, del;
-    float logQmax;
-    float dummy;
-
-
-    if (MFDateGetDayOfYear() == 1) {
-        MFVarSetFloat(_MDOutDischMaxID, itemID, 0.0);
-    }
-
+	const float *upSums;
 
 	Qday = MFVarGetFloat (_MDInDischargeID , itemID, 0.0);	// in m3/s	
-    Qmax = MFVarGetFloat(_MDOutDischMaxID, itemID, 0.0);
-    if (Qday > Qmax) {
-        MFVarSetFloat(_MDOutDischMaxID, itemID, Qday);
-    } else {
-        MFVarSetFloat(_MDOutDischMaxID, itemID, Qmax);
-    }
-
-
-    if (MFDateGetDayOfYear() == MFDateGetYearLength()) {
-        Qmax = MFVarGetFloat(_MDOutDischMaxID, itemID, 0.0);
-        logQmax = 0;
-        if (Qmax > 0) 
-            logQmax = log10(Qmax);
-        // online (onepass) variance calculation, continues in MDBankfullQcalc.c (T.Terriberry)
-        nA = MFVarGetInt(_MDOutYearCountID, itemID, 0);
-        n = nA + 1;
-        muA = MFVarGetFloat(_MDOutMeanLogQMaxID, itemID, 0.0);
-        M2A = MFVarGetFloat(_MDOutLogQMaxM2ID, itemID, 0.0);
-        M3A = MFVarGetFloat(_MDOutLogQMaxM3ID, itemID, 0.0);
-        del = logQmax - muA;
-        mu = muA + del / n;
-        M2 = M2A + (del * del * nA / n);
-        M3 = M3A + (del * del * del * nA * (nA - 1) / (n * n)) + (3 * -M2A * del / n);
-
-        MFVarSetInt(_MDOutYearCountID, itemID, n);
-        MFVarSetFloat(_MDOutMeanLogQMaxID, itemID, mu);
-        MFVarSetFloat(_MDOutLogQMaxM2ID, itemID, M2);
-        MFVarSetFloat(_MDOutLogQMaxM3ID, itemID, M3);
-
-        // call this just to make bankfull calcs and save vals
-        dummy = MFVarGetFloat(_MDInBankfullQ5ID, itemID, 0.0);
-    } 
+	// annual maxima and their log moments for the bankfull return periods (MDRouting_FloodFrequency.c)
+	MDFloodFrequencyUpdate (itemID, Qday);
 	
     Qbar = MFVarGetFloat (_MDInDischMeanID   , itemID, 0.0);	// in m3/s
 	Tday = MFVarGetFloat (_MDInAirTempID     , itemID, 0.0);	// in C	
 //	A    = MFVarGetFloat (_MDInContributingAreaID, 	itemID, 0.0);	//in km2
-	A = MFVarGetFloat (_MDInContributingAreaAccID, itemID, 0.0) + (MFModelGetArea (itemID)/(pow(1000,2)));// convert from m2 to km2  //calculating the contributing area
+	if ((upSums = MDUpstreamSums (itemID)) == (const float *) NULL) return;
+	A = upSums [_MDAreaAccField]; //calculating the contributing area
 	MFVarSetFloat (_MDInContributingAreaAccID, itemID, A);
 	PixSize_km2 =(MFModelGetArea(itemID)/pow(1000,2));
 
@@ -145,11 +106,8 @@ int MDSediment_BQARTpreprocessDef () {
 	    ((_MDInBankfullQ5ID = MDRouting_BankfullQcalcDef ()) == CMfailed) ||
         ((_MDInAirTempID    = MDCommon_AirTemperatureDef ()) == CMfailed) ||
 	    ((_MDInTimeStepsID  = MDAux_StepCounterDef ())       == CMfailed) ||
-        ((_MDOutYearCountID          = MFVarGetID (MDVarAux_YearCount,                    "yr",     MFOutput, MFState, MFInitial))  == CMfailed) ||
-        ((_MDOutLogQMaxM2ID          = MFVarGetID (MDVarRouting_LogQMaxM2,                "m3/s",   MFOutput, MFState, MFInitial))  == CMfailed) ||
-        ((_MDOutLogQMaxM3ID          = MFVarGetID (MDVarRouting_LogQMaxM3,                "m3/s",   MFOutput, MFState, MFInitial))  == CMfailed) ||
-        ((_MDOutMeanLogQMaxID        = MFVarGetID (MDVarRouting_MeanLogQMax ,             "m3/s",   MFOutput, MFState, MFInitial))  == CMfailed) ||
-	    ((_MDInContributingAreaAccID = MFVarGetID (MDVarSediment_ContributingAreaAcc,     "km2",    MFRoute,  MFState, MFBoundary)) == CMfailed) ||
+	    ((_MDInYearCountID  = MDFloodFrequencyDef ())        == CMfailed) ||
+	    ((_MDInContributingAreaAccID = MFVarGetID (MDVarSediment_ContributingAreaAcc,     "km2",    MFOutput,  MFState, MFBoundary)) == CMfailed) ||
 	    ((_MDInAirTempAcc_timeID     = MFVarGetID (MDVarSediment_AirTemperatureAcc_time,  "degC",   MFOutput, MFState, MFInitial))  == CMfailed) ||
 	    ((_MDInAirTempAcc_spaceID    = MFVarGetID (MDVarSediment_AirTemperatureAcc_space, "degC",   MFRoute,  MFState, MFBoundary)) == CMfailed) ||
 	    ((_MDInDischargeAccID        = MFVarGetID (MDVarSediment_DischargeAcc,            "m3/s",   MFOutput, MFState, MFInitial))  == CMfailed) ||
@@ -158,7 +116,7 @@ int MDSediment_BQARTpreprocessDef () {
 	    ((_MDOutBQART_Qbar_m3sID     = MFVarGetID (MDVarSediment_BQART_Qbar_m3s,          "m3s",    MFOutput, MFState, MFBoundary)) == CMfailed) ||
 	    ((_MDOutBQART_Qbar_km3yID    = MFVarGetID (MDVarSediment_BQART_Qbar_km3y,         "km3/y",  MFOutput, MFState, MFBoundary)) == CMfailed) ||
 	    ((_MDOutBQART_TID            = MFVarGetID (MDVarSediment_BQART_T,                 "degC",   MFOutput, MFState, MFBoundary)) == CMfailed) ||
-        ((_MDOutDischMaxID           = MFVarGetID (MDVarAux_DischargeMax,                 "m3/s",   MFOutput, MFState, MFInitial))  == CMfailed) ||
+        ((_MDAreaAccField            = MDUpstreamSumDef (_MDQBARTArea)) == CMfailed) ||
        (MFModelAddFunction (_MDQBARTpreprocess) == CMfailed)) return (CMfailed);
 
 	MFDefLeaving  ("QBARTpreprocess");
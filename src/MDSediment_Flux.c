@@ -59,6 +59,47 @@ static int _MDOutLithologyMeanID      = MFUnset;
 static int _MDOutDeltaQsID            = MFUnset;
 static int _MDOutQsConcID             = MFUnset;
 static int _MDOutQsYieldID            = MFUnset;
+// Stochastic Psi model
+enum { MDSedimentRandDaily = 1, MDSedimentRandYearly = 2 }; // random streams of the daily and yearly terms
+static bool         _MDSedimentStochastic = false;
+static unsigned int _MDSedimentSeed       = 0;
+// Upstream sums of the static layers
+static int _MDAreaAccField            = MFUnset;
+static int _MDLithologyAreaAccField   = MFUnset;
+static int _MDPopulationAccField      = MFUnset;
+static int _MDGNPAreaAccField         = MFUnset;
+static int _MDResCapacityAccField     = MFUnset;
+
+static float _MDSedimentArea (int itemID) {
+	return (MFModelGetArea (itemID) / (pow (1000,2))); // convert from m2 to km2
+}
+
+static float _MDSedimentLithologyArea (int itemID) {
+	float L = MFVarGetFloat (_MDInBQART_LithologyID, itemID, 0.0); //no units
+
+	if (L <= 0) L = 1.0;
+	return (L * (MFModelGetArea (itemID) / pow (1000,2)));
+}
+
+// Population and GNP are not accumulated in pristine cells, reservoirs only in disturbed ones
+static float _MDSedimentPopulation (int itemID) {
+	return (MFVarGetInt (_MDInMDVarSedPristineID, itemID, 0.0) != 1 ? MFVarGetFloat (_MDInPopulationID, itemID, 0.0) : 0.0);
+}
+
+static float _MDSedimentGNPArea (int itemID) {
+	float PixSize_km2 = (MFModelGetArea (itemID) / pow (1000,2));
+
+	return (MFVarGetInt (_MDInMDVarSedPristineID, itemID, 0.0) != 1 ? MFVarGetFloat (_MDInBQART_GNPID, itemID, 0.0) * PixSize_km2 : 0.0);
+}
+
+static float _MDSedimentResCapacity (int itemID) {
+	float LargeResCapacity;
+
+	if (MFVarGetInt (_MDInMDVarSedPristineID, itemID, 0.0) != 0) return (0.0);
+	LargeResCapacity = MFVarGetFloat (_MDInResCapacityID, itemID, 0.0);
+	if (LargeResCapacity < 0.0001) LargeResCapacity = 0.0000000;
+	return (LargeResCapacity < 0 ? 0.00 : LargeResCapacity);
+}
 
 static void _MDSedimentFlux (int itemID) {
 	float Qs, Qsbar;
@@ -72,14 +113,17 @@ static void _MDSedimentFlux (int itemID) {
 	float A, R;
 	float Ag;
 	float tmp,TupSlop,PixSize_km2;
-	float ResCapacity, ResCapacityAcc, TeQacc ,deltaTau,upStreamResCapacity,LargeResCapacity;
+	float ResCapacity, ResCapacityAcc, TeQacc ,deltaTau;
 	float PopulationAcc,PopuDesity, MeanGNP,GNPAreaAcc;
-	static float dailyRand, yearlyRand;
+	float dailyRand, yearlyRand;
 //	static int tmpTimeStep,tempTimeStep;
 //	static int dayCount;
 	float s,sigma,cbar, Psi, C;
 	float QsConc,QsYield; //upstream_Qs,deltaQs,
 	float percentDiff=0;
+	const float *upSums;
+
+	if ((upSums = MDUpstreamSums (itemID)) == (const float *) NULL) return;
 //Geting the values of these parameters
 	PixSize_km2 =(MFModelGetArea(itemID)/pow(1000,2));
 	Qday = MFVarGetFloat (_MDInDischargeID   , 	itemID, 0.0);	// in m3/s	
@@ -87,7 +131,7 @@ static void _MDSedimentFlux (int itemID) {
 	Tday = MFVarGetFloat (_MDInAirTempID, 		itemID, 0.0);	// in C	
 	R    = MFVarGetFloat (_MDInReliefID, 		itemID, 0.0);	// in m 
 //Calculating contributing area for each pixel
-	A = MFVarGetFloat (_MDInContributingAreaAccID, itemID, 0.0) + (MFModelGetArea (itemID)/(pow(1000,2)));// convert from m2 to km2  //calculating the contributing area
+	A = upSums [_MDAreaAccField]; //calculating the contributing area
 	MFVarSetFloat (_MDInContributingAreaAccID, itemID, A);
 	//A    = MFVarGetFloat (_MDInContributingAreaID, 	itemID, 0.0);	//in km2
 	//if (A <= 0) A = PixSize_km2;
@@ -122,9 +166,7 @@ static void _MDSedimentFlux (int itemID) {
 	I  = 1 + 0.09 * Ag; 
 	
 	//Calculating catchmant average lithology
-	L  = MFVarGetFloat (_MDInBQART_LithologyID, itemID, 0.0);	//no units
-	if (L <= 0) L = 1.0;
-	upLithologyArea =  MFVarGetFloat(_MDOutLithologyAreaAccID, itemID, 0.0) + L * (MFModelGetArea (itemID)/pow(1000,2));
+	upLithologyArea = upSums [_MDLithologyAreaAccField];
 	MFVarSetFloat (_MDOutLithologyAreaAccID, itemID, upLithologyArea);
 	//Lbar = upLithologyArea/A;
 	MFVarSetFloat (_MDOutLithologyMeanID, itemID, (upLithologyArea/A));
@@ -133,18 +175,10 @@ static void _MDSedimentFlux (int itemID) {
 	SedPristine = MFVarGetInt (_MDInMDVarSedPristineID, itemID, 0.0);
 	if (SedPristine == 0 ){ //NOT pristine -- disturbed
 		// Calculating reservoir trapping (Te)
-		ResCapacity = 0.0;
-		ResCapacityAcc = 0.0;
-		//TeQacc = 0.0;
-		LargeResCapacity = MFVarGetFloat (_MDInResCapacityID,	   itemID, 0.0);
-		if (LargeResCapacity < 0.0001) LargeResCapacity = 0.0000000;
-		ResCapacity = LargeResCapacity;
-		//ResCapacity = LargeResCapacity;
-		if (ResCapacity < 0) ResCapacity = 0.00;
+		ResCapacity = _MDSedimentResCapacity (itemID);
 	
 		//Calculating basin trapping efficiency Using Vorosmarty et al. 1997 method
-		upStreamResCapacity = MFVarGetFloat (_MDInResCapacityAccID, itemID, 0.0);
-		ResCapacityAcc = upStreamResCapacity + ResCapacity;
+		ResCapacityAcc = upSums [_MDResCapacityAccField];
 		MFVarSetFloat (_MDInResCapacityAccID, itemID, ResCapacityAcc);
 		//TeAacc = MFVarGetFloat (_MDInTeAaccID, itemID, 0.0); ///new
 		TeQacc = MFVarGetFloat (_MDInTeAaccID, itemID, 0.0); ///new
@@ -163,12 +197,12 @@ static void _MDSedimentFlux (int itemID) {
 
 		//Calculating Eh
 		// Calculating mean population density
-		PopulationAcc = MFVarGetFloat(_MDOutPopulationAccID, itemID, 0.0) + MFVarGetFloat(_MDInPopulationID, itemID, 0.0); 
+		PopulationAcc = upSums [_MDPopulationAccField];
 		MFVarSetFloat (_MDOutPopulationAccID, itemID, PopulationAcc);
 		PopuDesity = PopulationAcc/A;
 		MFVarSetFloat (_MDOutPopulationDensityID, itemID, PopuDesity);
 		// Calculating mean GNP
-		GNPAreaAcc = MFVarGetFloat(_MDOutGNPAreaAccID, itemID, 0.0) + (MFVarGetFloat(_MDInBQART_GNPID, itemID, 0.0) * PixSize_km2);
+		GNPAreaAcc = upSums [_MDGNPAreaAccField];
 		MFVarSetFloat (_MDOutGNPAreaAccID, itemID, GNPAreaAcc);
 		if (GNPAreaAcc == 0)
 			MeanGNP = 0;
@@ -193,12 +227,12 @@ static void _MDSedimentFlux (int itemID) {
 	if (SedPristine == 2) { // semi-Pristine sediment (no reservoirs !!!!!
 		// Calculating Eh
 		// Calculating mean population density
-		PopulationAcc = MFVarGetFloat(_MDOutPopulationAccID, itemID, 0.0) + MFVarGetFloat(_MDInPopulationID, itemID, 0.0); //devided by 25 for the 06min simulation in order to account for the smaler pixel size.
+		PopulationAcc = upSums [_MDPopulationAccField];
 		MFVarSetFloat (_MDOutPopulationAccID, itemID, PopulationAcc);
 		PopuDesity = PopulationAcc/A;
 		MFVarSetFloat (_MDOutPopulationDensityID, itemID, PopuDesity);
 		// Calculating mean GNP
-		GNPAreaAcc = MFVarGetFloat(_MDOutGNPAreaAccID, itemID, 0.0) + (MFVarGetFloat(_MDInBQART_GNPID, itemID, 0.0) * PixSize_km2);
+		GNPAreaAcc = upSums [_MDGNPAreaAccField];
 		MFVarSetFloat (_MDOutGNPAreaAccID, itemID, GNPAreaAcc);
 		if (GNPAreaAcc == 0)
 			MeanGNP = 0;
@@ -225,12 +259,12 @@ static void _MDSedimentFlux (int itemID) {
 		if (Te < 0) Te = 0.0;
 			//Calculating Eh
 		// Calculating mean population density
-		PopulationAcc = MFVarGetFloat(_MDOutPopulationAccID, itemID, 0.0) + MFVarGetFloat(_MDInPopulationID, itemID, 0.0); 
+		PopulationAcc = upSums [_MDPopulationAccField];
 		MFVarSetFloat (_MDOutPopulationAccID, itemID, PopulationAcc);
 		PopuDesity = PopulationAcc/A;
 		MFVarSetFloat (_MDOutPopulationDensityID, itemID, PopuDesity);
 		// Calculating mean GNP
-		GNPAreaAcc = MFVarGetFloat(_MDOutGNPAreaAccID, itemID, 0.0) + (MFVarGetFloat(_MDInBQART_GNPID, itemID, 0.0) * PixSize_km2);
+		GNPAreaAcc = upSums [_MDGNPAreaAccField];
 		MFVarSetFloat (_MDOutGNPAreaAccID, itemID, GNPAreaAcc);
 		if (GNPAreaAcc == 0)
 			MeanGNP = 0;
@@ -274,8 +308,13 @@ static void _MDSedimentFlux (int itemID) {
 	if (Qsbar == 0) cbar = 0;
 	MFVarSetFloat (_MDOutDeltaQsID, itemID, cbar);
 
-dailyRand = 0.00001; // Eliminate daily randomness !!!
-yearlyRand = 0.00001;// Eliminate Yearly randomness!!!
+	if (_MDSedimentStochastic) { // standard normal deviates, the yearly one is drawn on day 0 of each year
+		MDRandomNormal (_MDSedimentSeed, MDSedimentRandDaily,  itemID, MFDateGetCurrentYear (), MFDateGetDayOfYear (), 1, &dailyRand);
+		MDRandomNormal (_MDSedimentSeed, MDSedimentRandYearly, itemID, MFDateGetCurrentYear (), 0,                      1, &yearlyRand);
+	} else {
+		dailyRand = 0.00001; // Eliminate daily randomness !!!
+		yearlyRand = 0.00001;// Eliminate Yearly randomness!!!
+	}
 
 	Psi= exp((sigma * dailyRand)); 
 	
@@ -295,8 +334,22 @@ yearlyRand = 0.00001;// Eliminate Yearly randomness!!!
 }
 
 int MDSediment_FluxDef() {
-	
+	const char *optStr;
+
+	if (_MDOutSedimentFluxID != MFUnset) return (_MDOutSedimentFluxID);
+
 	MFDefEntering ("SedimentFlux");
+	if ((optStr = MFOptionGet (MDOptSediment_Stochastic)) != (char *) NULL) {
+		switch (CMoptLookup (MFswitchOptions, optStr, true)) {
+			case MFon:  _MDSedimentStochastic = true;  break;
+			case MFoff: _MDSedimentStochastic = false; break;
+			default: MFOptionMessage (MDOptSediment_Stochastic, optStr, MFswitchOptions); return (CMfailed);
+		}
+	}
+	if (((optStr = MFOptionGet (MDParRandomSeed)) != (char *) NULL) && (sscanf (optStr, "%u", &_MDSedimentSeed) != 1)) {
+		CMmsgPrint (CMmsgUsrError, "Invalid %s [%s] in: %s:%d\n", MDParRandomSeed, optStr, __FILE__, __LINE__);
+		return (CMfailed);
+	}
 	
 	if (((_MDInDischargeID 		     = MDRouting_DischargeDef ())          == CMfailed) ||
 	    ((_MDInDischMeanID 		     = MDAux_DischargeMeanDef ())          == CMfailed) ||
@@ -311,7 +364,7 @@ int MDSediment_FluxDef() {
 	    ((_MDInAirTempAcc_spaceID    = MFVarGetID (MDVarSediment_AirTemperatureAcc_space,   "degC",     MFRoute,  MFState, MFBoundary)) == CMfailed) ||
 	    ((_MDInResCapacityID         = MFVarGetID (MDVarReservoir_Capacity,                 "km3",      MFInput,  MFState, MFBoundary)) == CMfailed) ||
 	    ((_MDInTeAaccID              = MFVarGetID (MDVarSediment_TeAacc,                    "",         MFRoute,  MFState, MFBoundary)) == CMfailed) ||
-	    ((_MDInContributingAreaAccID = MFVarGetID (MDVarSediment_ContributingAreaAcc,       "km2",      MFRoute,  MFState, MFBoundary)) == CMfailed) ||
+	    ((_MDInContributingAreaAccID = MFVarGetID (MDVarSediment_ContributingAreaAcc,       "km2",      MFOutput,  MFState, MFBoundary)) == CMfailed) ||
 	    ((_MDInUpStreamQsID          = MFVarGetID (MDVarSediment_UpStreamQs,                "kg/s",     MFRoute,  MFState, MFBoundary)) == CMfailed) ||
 	    ((_MDInMDVarSedPristineID    = MFVarGetID (MDVarSediment_Pristine,                  MFNoUnit,   MFInput,  MFState, MFBoundary)) == CMfailed) ||
 	    ((_MDInSedimentTrappingID    = MFVarGetID (MDVarSediment_Trapping,                  MFNoUnit,   MFInput,  MFState, MFBoundary)) == CMfailed) ||
@@ -322,19 +375,24 @@ int MDSediment_FluxDef() {
 	    ((_MDOutBQART_AID            = MFVarGetID (MDVarSediment_BQART_A,                   "km2",      MFRoute,  MFState, MFBoundary)) == CMfailed) ||
 	    ((_MDOutBQART_RID            = MFVarGetID (MDVarSediment_BQART_R,                   "km" ,      MFRoute,  MFState, MFBoundary)) == CMfailed) ||
 	    ((_MDOutBQART_TID            = MFVarGetID (MDVarSediment_BQART_T,                   "degC",     MFRoute,  MFState, MFBoundary)) == CMfailed) ||
-   	    ((_MDOutPopulationAccID      = MFVarGetID (MDVarSediment_PopulationAcc,             "",         MFRoute,  MFState, MFBoundary)) == CMfailed) ||
-	    ((_MDInResCapacityAccID      = MFVarGetID (MDVarSediment_ResStorageAcc,             "km3",      MFRoute,  MFState, MFBoundary)) == CMfailed) ||
+   	    ((_MDOutPopulationAccID      = MFVarGetID (MDVarSediment_PopulationAcc,             "",         MFOutput,  MFState, MFBoundary)) == CMfailed) ||
+	    ((_MDInResCapacityAccID      = MFVarGetID (MDVarSediment_ResStorageAcc,             "km3",      MFOutput,  MFState, MFBoundary)) == CMfailed) ||
 	    ((_MDOutPopulationDensityID  = MFVarGetID (MDVarSediment_PopulationDensity,         "km2",      MFOutput, MFState, MFBoundary)) == CMfailed) ||
-	    ((_MDOutGNPAreaAccID         = MFVarGetID (MDVarSediment_GNPAreaAcc,                " ",        MFRoute,  MFState, MFBoundary)) == CMfailed) ||
+	    ((_MDOutGNPAreaAccID         = MFVarGetID (MDVarSediment_GNPAreaAcc,                " ",        MFOutput,  MFState, MFBoundary)) == CMfailed) ||
 	    ((_MDOutMeanGNPID            = MFVarGetID (MDVarSediment_MeanGNP,                   " ",        MFOutput, MFState, MFBoundary)) == CMfailed) ||
 	    ((_MDOutBQART_EhID           = MFVarGetID (MDVarSediment_BQART_Eh,                  " ",        MFOutput, MFState, MFBoundary)) == CMfailed) ||
 	    ((_MDOutBQART_TeID           = MFVarGetID (MDVarSediment_BQART_Te,                  " ",        MFOutput, MFState, MFBoundary)) == CMfailed) ||
 	    ((_MDOutQs_barID             = MFVarGetID (MDVarSediment_Qs_bar,                    "kg/s",     MFRoute,  MFState, MFBoundary)) == CMfailed) ||
- 	    ((_MDOutLithologyAreaAccID   = MFVarGetID (MDVarSediment_LithologyAreaAcc,          "",         MFRoute,  MFState, MFBoundary)) == CMfailed) ||
+ 	    ((_MDOutLithologyAreaAccID   = MFVarGetID (MDVarSediment_LithologyAreaAcc,          "",         MFOutput,  MFState, MFBoundary)) == CMfailed) ||
 	    ((_MDOutLithologyMeanID      = MFVarGetID (MDVarSediment_LithologyMean,             "" ,        MFOutput, MFState, MFBoundary)) == CMfailed) ||
 	    ((_MDOutDeltaQsID            = MFVarGetID (MDVarSediment_DeltaQs,                   "kg/s",     MFOutput, MFState, MFBoundary)) == CMfailed) ||
 	    ((_MDOutQsConcID             = MFVarGetID (MDVarSediment_QsConc,                    "kg/m3",    MFOutput, MFState, MFBoundary)) == CMfailed) ||
 	    ((_MDOutQsYieldID            = MFVarGetID (MDVarSediment_QsYield,                   "kg/s/km2", MFOutput, MFState, MFBoundary)) == CMfailed) ||
+	    ((_MDAreaAccField            = MDUpstreamSumDef (_MDSedimentArea))          == CMfailed) ||
+	    ((_MDLithologyAreaAccField   = MDUpstreamSumDef (_MDSedimentLithologyArea)) == CMfailed) ||
+	    ((_MDPopulationAccField      = MDUpstreamSumDef (_MDSedimentPopulation))    == CMfailed) ||
+	    ((_MDGNPAreaAccField         = MDUpstreamSumDef (_MDSedimentGNPArea))       == CMfailed) ||
+	    ((_MDResCapacityAccField     = MDUpstreamSumDef (_MDSedimentResCapacity))   == CMfailed) ||
 	(MFModelAddFunction (_MDSedimentFlux) == CMfailed)) return (CMfailed);
 
 	MFDefLeaving  ("SedimentFlux");
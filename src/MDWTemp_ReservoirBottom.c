@@ -9,8 +9,11 @@ bfekete@gc.cuny.edu
 
 *******************************************************************************/
 
+#include <stdlib.h>
+#include <stddef.h>
 #include <string.h>
 #include <math.h>
+#include <pthread.h>
 #include <MF.h>
 #include <MD.h>
 #include <res_strat.h>
@@ -63,6 +66,119 @@ static int _MDOutWTemp_ReservoirNLayerID = MFUnset;
 
 #define MinTemp 1.0
 
+static float  _MDStratTolerance     = 0.0; // Largest layer temperature change per adaptive sub-timestep (K), fixed sub-timesteps when 0
+static int    _MDStratCompare       = MFoff;
+static double _MDStratCompareMaxErr = 0.0;
+static int    _MDStratLayerStates   = MFon; // Mirror the packed layer states to the MF state variables every day
+
+// Packed double precision state of a stratifying reservoir carried between days
+typedef struct MDStratState_s {
+    int    Loaded;
+    int    NDepth;
+    double DRes, DDzMin, DDzMax, STin, MCal;
+    double DDz [NLAYER_MAX];
+    double DZ  [NLAYER_MAX];
+    double TZ  [NLAYER_MAX];
+    double AD  [NLAYER_MAX];
+    double MZn [NLAYER_MAX];
+    double DV  [NLAYER_MAX];
+    double VZt [NLAYER_MAX];
+    struct reservoir_dav Dav; // Depth-area-volume tables, built by the first stratify call
+} MDStratState_t;
+
+// Records are allocated one by one so that their addresses stay valid while the item table grows.
+// Only the table lookup is serialized, the stratification of different items can run concurrently.
+static MDStratState_t **_MDStratStates   = (MDStratState_t **) NULL; // State record of each item, NULL if the item has none
+static int              _MDStratStateNum = 0;
+static pthread_mutex_t  _MDStratMutex    = PTHREAD_MUTEX_INITIALIZER;
+
+static MDStratState_t *_MDStratStateRecord (int itemID) {
+    int i;
+    MDStratState_t *state;
+
+    pthread_mutex_lock (&_MDStratMutex);
+    if (itemID >= _MDStratStateNum) {
+        if ((_MDStratStates = (MDStratState_t **) realloc (_MDStratStates, (itemID + 1) * sizeof (MDStratState_t *))) == (MDStratState_t **) NULL) {
+            CMmsgPrint (CMmsgSysError, "Memory allocation error in: %s:%d", __FILE__, __LINE__);
+            pthread_mutex_unlock (&_MDStratMutex);
+            return ((MDStratState_t *) NULL);
+        }
+        for (i = _MDStratStateNum; i <= itemID; ++i) _MDStratStates [i] = (MDStratState_t *) NULL;
+        _MDStratStateNum = itemID + 1;
+    }
+    if ((state = _MDStratStates [itemID]) == (MDStratState_t *) NULL) {
+        if ((state = _MDStratStates [itemID] = (MDStratState_t *) calloc (1, sizeof (MDStratState_t))) == (MDStratState_t *) NULL)
+            CMmsgPrint (CMmsgSysError, "Memory allocation error in: %s:%d", __FILE__, __LINE__);
+    }
+    pthread_mutex_unlock (&_MDStratMutex);
+    return (state);
+}
+
+// Checkpoint section: the records up to the depth-area-volume tables, which are rebuilt on the first call
+#define MDStratCheckpointSize ((int) offsetof (MDStratState_t, Dav))
+
+// The item table may be reallocated by a concurrent _MDStratStateRecord, so it is only read under the mutex.
+static int _MDStratCheckpointItemNum () {
+    int itemNum;
+
+    pthread_mutex_lock (&_MDStratMutex);
+    itemNum = _MDStratStateNum;
+    pthread_mutex_unlock (&_MDStratMutex);
+    return (itemNum);
+}
+
+static const void *_MDStratCheckpointGet (int itemID) {
+    const MDStratState_t *state;
+
+    pthread_mutex_lock (&_MDStratMutex);
+    state = itemID < _MDStratStateNum ? _MDStratStates [itemID] : (MDStratState_t *) NULL;
+    pthread_mutex_unlock (&_MDStratMutex);
+    return ((state != (MDStratState_t *) NULL) && state->Loaded ? (const void *) state : (const void *) NULL);
+}
+
+static void *_MDStratCheckpointSet (int itemID) { return ((void *) _MDStratStateRecord (itemID)); }
+
+static MDStratState_t *_MDStratStateGet (int itemID) {
+    int layer;
+    MDStratState_t *state;
+
+    if ((state = _MDStratStateRecord (itemID)) == (MDStratState_t *) NULL) return (state);
+
+    if (!state->Loaded) { // First visit: pick up the initial (or restart) state from the MF state variables
+        state->STin   = MFVarGetFloat (_MDStateStrat_s_tin,            itemID, 0.0);
+        state->MCal   = MFVarGetFloat (_MDStateStrat_m_cal,            itemID, 0.0);
+        state->DRes   = MFVarGetFloat (_MDStateStrat_resGeom_d_res,    itemID, 0.0);
+        state->DDzMin = MFVarGetFloat (_MDStateStrat_resGeom_ddz_min,  itemID, 0.0);
+        state->DDzMax = MFVarGetFloat (_MDStateStrat_resGeom_ddz_max,  itemID, 0.0);
+        state->NDepth = MFVarGetInt   (_MDStateStrat_resGeom_n_depth,  itemID, 0);
+        for (layer = 0; layer < NLAYER_MAX; ++layer) {
+            state->DDz [layer] = MFVarGetFloat (_MDStateStrat_resGeom_dd_z [layer], itemID, 0.0);
+            state->DZ  [layer] = MFVarGetFloat (_MDStateStrat_dZ  [layer], itemID, 0.0);
+            state->TZ  [layer] = MFVarGetFloat (_MDStateStrat_tZ  [layer], itemID, 0.0);
+            state->AD  [layer] = MFVarGetFloat (_MDStateStrat_aD  [layer], itemID, 0.0);
+            state->MZn [layer] = MFVarGetFloat (_MDStateStrat_mZn [layer], itemID, 0.0);
+            state->DV  [layer] = MFVarGetFloat (_MDStateStrat_dV  [layer], itemID, 0.0);
+            state->VZt [layer] = MFVarGetFloat (_MDStateStrat_vZt [layer], itemID, 0.0);
+        }
+        state->Loaded = true;
+    }
+    return (state);
+}
+
+static void _MDStratLayerStatesSet (int itemID, const MDStratState_t *state) {
+    int layer;
+
+    for (layer = 0; layer < NLAYER_MAX; ++layer) {
+        MFVarSetFloat (_MDStateStrat_resGeom_dd_z [layer], itemID, state != (MDStratState_t *) NULL ? state->DDz [layer] : 0.0);
+        MFVarSetFloat (_MDStateStrat_dZ  [layer], itemID, state != (MDStratState_t *) NULL ? state->DZ  [layer] : 0.0);
+        MFVarSetFloat (_MDStateStrat_tZ  [layer], itemID, state != (MDStratState_t *) NULL ? state->TZ  [layer] : 0.0);
+        MFVarSetFloat (_MDStateStrat_aD  [layer], itemID, state != (MDStratState_t *) NULL ? state->AD  [layer] : 0.0);
+        MFVarSetFloat (_MDStateStrat_mZn [layer], itemID, state != (MDStratState_t *) NULL ? state->MZn [layer] : 0.0);
+        MFVarSetFloat (_MDStateStrat_dV  [layer], itemID, state != (MDStratState_t *) NULL ? state->DV  [layer] : 0.0);
+        MFVarSetFloat (_MDStateStrat_vZt [layer], itemID, state != (MDStratState_t *) NULL ? state->VZt [layer] : 0.0);
+    }
+}
+
 static void _MDWTempReservoirBottom (int itemID) {
 // Input
     double inflow        = MFVarGetFloat (_MDInReservoir_InflowID,      itemID, 0.0); // Innflow in m3/s 
@@ -75,16 +191,19 @@ static void _MDWTempReservoirBottom (int itemID) {
     double solarRad      = MFVarGetFloat (_MDInCommon_SolarRadID,       itemID, 0.0); // Solar radiation W/m2 
     double radAbsorption = MFVarGetFloat (_MDInCommon_RadAbsortionID,   itemID, 0.0); // Radiation absoption W/m2 
     struct reservoir_geometry resGeom;
+// State
+    MDStratState_t *state;
 // Output
     float riverTempBottom; // River bottom temperature in degC
 // Model
     float dt = MFModelGet_dt (); // Model time step in seconds
 // Local
-    int tStep, layer, resError;
-    double dZ[NLAYER_MAX], tZ[NLAYER_MAX], aD[NLAYER_MAX], mZn[NLAYER_MAX], dV[NLAYER_MAX], vZt[NLAYER_MAX];
-    double s_tin;
-    double m_cal;
+    int tStep, resError;
     int lme_error;
+    MDStratState_t refState;
+    struct reservoir_geometry refGeom;
+    double refRelease, refErr;
+    int refError = 1;
     int year = 0;
     int   day    = MFDateGetDayOfYear ();
 	float lambda = MFModelGetLatitude (itemID);
@@ -98,8 +217,7 @@ static void _MDWTempReservoirBottom (int itemID) {
     resGeom.gm_j    = (int) (MFVarGetFloat (_MDInStrat_GMjID,  itemID, 0.0));
     resError        = MFVarGetInt   (_MDStateStrat_error,   itemID, 0);
     if (resGeom.gm_j != 0 && resError == 0) { // Reservoir has ResGeo geometry to compute stratification
-        s_tin           = MFVarGetFloat (_MDStateStrat_s_tin,      itemID, 0.0);
-        m_cal           = MFVarGetFloat (_MDStateStrat_m_cal,      itemID, 0.0);
+        if ((state = _MDStratStateGet (itemID)) == (MDStratState_t *) NULL) return;
         resGeom.depth   = MFVarGetFloat (_MDInStrat_DepthID,       itemID, 0.0);
         resGeom.d_ht    = MFVarGetFloat (_MDInStrat_HeightID,      itemID, 0.0);
         resGeom.M_L     = MFVarGetFloat (_MDInStrat_LengthID,      itemID, 0.0);
@@ -110,20 +228,12 @@ static void _MDWTempReservoirBottom (int itemID) {
         resGeom.C_a     = MFVarGetFloat (_MDInStrat_AreaCoeffID,   itemID, 0.0);
         resGeom.V_df    = MFVarGetFloat (_MDInStrat_VolumeDiffID,  itemID, 0.0);
         resGeom.A_df    = MFVarGetFloat (_MDInStrat_AreaDiffID,    itemID, 0.0);
-        resGeom.d_res   = MFVarGetFloat (_MDStateStrat_resGeom_d_res, itemID, 0.0);
-        resGeom.ddz_min = MFVarGetFloat (_MDStateStrat_resGeom_ddz_min, itemID, 0.0);
-        resGeom.ddz_max = MFVarGetFloat (_MDStateStrat_resGeom_ddz_max, itemID, 0.0);
-        resGeom.n_depth = MFVarGetInt   (_MDStateStrat_resGeom_n_depth,   itemID, 0);
+        resGeom.d_res   = state->DRes;
+        resGeom.ddz_min = state->DDzMin;
+        resGeom.ddz_max = state->DDzMax;
+        resGeom.n_depth = state->NDepth;
+        memcpy (resGeom.dd_z, state->DDz, sizeof (resGeom.dd_z));
 
-        for (layer = 0; layer < NLAYER_MAX; ++layer) {
-            resGeom.dd_z[layer] = MFVarGetFloat (_MDStateStrat_resGeom_dd_z [layer], itemID, 0.0);
-            dZ [layer] = MFVarGetFloat (_MDStateStrat_dZ [layer], itemID, 0.0);
-            tZ [layer] = MFVarGetFloat (_MDStateStrat_tZ [layer], itemID, 0.0);
-            aD [layer] = MFVarGetFloat (_MDStateStrat_aD [layer], itemID, 0.0);
-            mZn[layer] = MFVarGetFloat (_MDStateStrat_mZn[layer], itemID, 0.0);
-            dV [layer] = MFVarGetFloat (_MDStateStrat_dV [layer], itemID, 0.0);
-            vZt[layer] = MFVarGetFloat (_MDStateStrat_vZt[layer], itemID, 0.0);
-        }
         airTemp      += 273.15;
         riverTempTop += 273.15;
 
@@ -135,37 +245,53 @@ static void _MDWTempReservoirBottom (int itemID) {
 
         CMmsgPrint (CMmsgDebug, "\nCellID %d:\n",itemID);
         CMmsgPrint (CMmsgDebug, "\nCellID %d:\n",itemID);
-        CMmsgPrint (CMmsgDebug, "\tincoming values: tStep=%d s_tin=%f, m_cal=%f\n",tStep,s_tin,m_cal);
+        CMmsgPrint (CMmsgDebug, "\tincoming values: tStep=%d s_tin=%f, m_cal=%f\n",tStep,state->STin,state->MCal);
 
-        stratify(tStep, &lme_error, &riverTempTop, &inflow, &release,
-                 &cosZen, &radAbsorption, &solarRad, &humidityRel, &airTemp, &windSpeed,
-                 &resGeom, (double **) &dZ, (double **) &tZ, (double **) &mZn, (double **) &aD, (double **) &dV,
-                 (double **) &vZt, &s_tin, &m_cal);
+        if (_MDStratCompare == MFon) { // Fixed sub-timestep reference run on a copy of the state
+            refState   = *state;
+            refGeom    = resGeom;
+            refRelease = release;
+            stratify_cached(&refState.Dav, tStep, &refError, &riverTempTop, &inflow, &refRelease,
+                            &cosZen, &radAbsorption, &solarRad, &humidityRel, &airTemp, &windSpeed,
+                            &refGeom, (double **) refState.DZ, (double **) refState.TZ, (double **) refState.MZn, (double **) refState.AD, (double **) refState.DV,
+                            (double **) refState.VZt, &refState.STin, &refState.MCal, 0.0);
+        }
+        stratify_cached(&state->Dav, tStep, &lme_error, &riverTempTop, &inflow, &release,
+                        &cosZen, &radAbsorption, &solarRad, &humidityRel, &airTemp, &windSpeed,
+                        &resGeom, (double **) state->DZ, (double **) state->TZ, (double **) state->MZn, (double **) state->AD, (double **) state->DV,
+                        (double **) state->VZt, &state->STin, &state->MCal, _MDStratTolerance);
+        if ((_MDStratCompare == MFon) && (refError == 0) && (lme_error == 0)) {
+            refErr = fabs (state->TZ[resGeom.n_depth - 1] - refState.TZ[refGeom.n_depth - 1]);
+            CMmsgPrint (CMmsgDebug, "\tbottom temperature difference from fixed sub-timesteps: %f\n", refErr);
+            pthread_mutex_lock (&_MDStratMutex);
+            if (refErr > _MDStratCompareMaxErr) {
+                _MDStratCompareMaxErr = refErr;
+                CMmsgPrint (CMmsgInfo, "Largest reservoir bottom temperature difference from fixed sub-timesteps so far: %f degC at CellID %d\n", refErr, itemID + 1);
+            }
+            pthread_mutex_unlock (&_MDStratMutex);
+        }
 
-        CMmsgPrint (CMmsgDebug, "\toutcoming values: tStep=%d s_tin=%f, m_cal=%f\n",tStep,s_tin,m_cal);
+        CMmsgPrint (CMmsgDebug, "\toutcoming values: tStep=%d s_tin=%f, m_cal=%f\n",tStep,state->STin,state->MCal);
         if (lme_error != 0) {CMmsgPrint (CMmsgUsrError, "stratify error code at tStep=%d for CellID %d: lme_error=%d\n",tStep,itemID+1,lme_error);}
 
-        riverTempBottom = tZ[resGeom.n_depth - 1] - 273.15;
+        state->DRes   = resGeom.d_res;
+        state->DDzMin = resGeom.ddz_min;
+        state->DDzMax = resGeom.ddz_max;
+        state->NDepth = resGeom.n_depth;
+        memcpy (state->DDz, resGeom.dd_z, sizeof (state->DDz));
+
+        riverTempBottom = state->TZ[resGeom.n_depth - 1] - 273.15;
         MFVarSetFloat (_MDOutWTemp_ReservoirBottomID, itemID, lme_error == 0 ? riverTempBottom : (riverTempTop - 273.15));
         MFVarSetFloat (_MDOutWTemp_ReservoirNLayerID, itemID, (float) (resGeom.n_depth > 0 ? (float) resGeom.n_depth : 1.0));
-        MFVarSetFloat (_MDStateStrat_s_tin, itemID, s_tin);
-        MFVarSetFloat (_MDStateStrat_m_cal, itemID, m_cal);
+        MFVarSetFloat (_MDStateStrat_s_tin, itemID, state->STin);
+        MFVarSetFloat (_MDStateStrat_m_cal, itemID, state->MCal);
         MFVarSetFloat (_MDStateStrat_error, itemID, lme_error);
 
         MFVarSetFloat (_MDStateStrat_resGeom_d_res, itemID, resGeom.d_res);
         MFVarSetFloat (_MDStateStrat_resGeom_ddz_min, itemID, resGeom.ddz_min);
         MFVarSetFloat (_MDStateStrat_resGeom_ddz_max, itemID, resGeom.ddz_max);
         MFVarSetInt   (_MDStateStrat_resGeom_n_depth,   itemID, resGeom.n_depth);
-
-        for (layer = 0; layer < NLAYER_MAX; ++layer) {
-            MFVarSetFloat (_MDStateStrat_resGeom_dd_z [layer], itemID, resGeom.dd_z [layer]);
-            MFVarSetFloat (_MDStateStrat_dZ [layer], itemID, dZ [layer]);
-            MFVarSetFloat (_MDStateStrat_tZ [layer], itemID, tZ [layer]);
-            MFVarSetFloat (_MDStateStrat_aD [layer], itemID, aD [layer]);
-            MFVarSetFloat (_MDStateStrat_mZn[layer], itemID, mZn[layer]);
-            MFVarSetFloat (_MDStateStrat_dV [layer], itemID, dV [layer]);
-            MFVarSetFloat (_MDStateStrat_vZt[layer], itemID, vZt[layer]);
-        }
+        if (_MDStratLayerStates == MFon) _MDStratLayerStatesSet (itemID, state);
     } else { // Reservoir does not have geometry to compute stratification
         MFVarSetFloat (_MDOutWTemp_ReservoirBottomID, itemID, riverTempTop);
         MFVarSetFloat (_MDOutWTemp_ReservoirNLayerID, itemID, 0.0);
@@ -175,21 +301,13 @@ static void _MDWTempReservoirBottom (int itemID) {
         MFVarSetFloat (_MDStateStrat_resGeom_ddz_min, itemID, 0.0);
         MFVarSetFloat (_MDStateStrat_resGeom_ddz_max, itemID, 0.0);
         MFVarSetInt   (_MDStateStrat_resGeom_n_depth,   itemID, 0);
-
-        for (layer = 0; layer < NLAYER_MAX; ++layer) {
-            MFVarSetFloat (_MDStateStrat_resGeom_dd_z [layer], itemID, 0.0);
-            MFVarSetFloat (_MDStateStrat_dZ [layer], itemID, 0.0);
-            MFVarSetFloat (_MDStateStrat_tZ [layer], itemID, 0.0);
-            MFVarSetFloat (_MDStateStrat_aD [layer], itemID, 0.0);
-            MFVarSetFloat (_MDStateStrat_mZn[layer], itemID, 0.0);
-            MFVarSetFloat (_MDStateStrat_dV [layer], itemID, 0.0);
-            MFVarSetFloat (_MDStateStrat_vZt[layer], itemID, 0.0);
-        }
+        if (_MDStratLayerStates == MFon) _MDStratLayerStatesSet (itemID, (MDStratState_t *) NULL);
     }
 }
 
 int MDWTemp_ReservoirBottomDef () {
     int i, optID = MFoff;
+    float par;
 	const char *optStr;
 	if (_MDOutWTemp_ReservoirBottomID != MFUnset) return (_MDOutWTemp_ReservoirBottomID);
 
@@ -200,6 +318,14 @@ int MDWTemp_ReservoirBottomDef () {
 		case MFoff: _MDOutWTemp_ReservoirBottomID = MDWTemp_RiverTopDef (); break;
 		case MFon:
 	        MFDefEntering ("Reservoir bottom temperature");
+            if ((optStr = MFOptionGet ("ReservoirStratTolerance")) != (char *) NULL) {
+                if (strcmp (optStr, MFhelpStr) == 0) CMmsgPrint (CMmsgInfo, "%s = %f", "ReservoirStratTolerance", _MDStratTolerance);
+                _MDStratTolerance = sscanf (optStr, "%f", &par) == 1 ? par : _MDStratTolerance;
+            }
+            if ((optStr = MFOptionGet ("ReservoirStratCompare")) != (char *) NULL) _MDStratCompare = CMoptLookup (MFswitchOptions, optStr, true);
+            if ((_MDStratCompare != MFon) && (_MDStratCompare != MFoff)) { MFOptionMessage ("ReservoirStratCompare", optStr, MFswitchOptions); return (CMfailed); }
+            if ((optStr = MFOptionGet ("ReservoirStratLayerStates")) != (char *) NULL) _MDStratLayerStates = CMoptLookup (MFswitchOptions, optStr, true);
+            if ((_MDStratLayerStates != MFon) && (_MDStratLayerStates != MFoff)) { MFOptionMessage ("ReservoirStratLayerStates", optStr, MFswitchOptions); return (CMfailed); }
     	    if (((_MDInAux_StepCounterID        = MDAux_StepCounterDef ())         == CMfailed) ||
                 ((_MDInReservoir_InflowID       = MDReservoir_InflowDef ())        == CMfailed) ||
                 ((_MDInReservoir_ReleaseID      = MDReservoir_OperationDef ())     == CMfailed) ||
@@ -230,9 +356,10 @@ int MDWTemp_ReservoirBottomDef () {
                 ((_MDStateStrat_resGeom_ddz_min = MFVarGetID ("ReservoirLayerMinDepth",   "m",  MFOutput, MFState, MFInitial)) == CMfailed) ||
                 ((_MDStateStrat_resGeom_ddz_max = MFVarGetID ("ReservoirLayerMaxDepth",   "m",  MFOutput, MFState, MFInitial)) == CMfailed) ||
                 ((_MDStateStrat_resGeom_n_depth = MFVarGetID ("ReservoirNumLayers",   MFNoUnit, MFOutput, MFState, MFInitial)) == CMfailed) ||
+            (MDCheckpointDef ("ReservoirStratification", MDStratCheckpointSize, _MDStratCheckpointItemNum, _MDStratCheckpointGet, _MDStratCheckpointSet) == CMfailed) ||
             (MFModelAddFunction (_MDWTempReservoirBottom) == CMfailed)) return (CMfailed);
             for (i = 0; i < NLAYER_MAX; ++i) {
-                char stateName [6][64];
+                char stateName [7][64];
                 if ((snprintf (stateName[0],sizeof(stateName[0]), "dZ%02d", i) == 0) || ((_MDStateStrat_dZ  [i] = MFVarGetID (stateName[0], MFNoUnit, MFFloat, MFState, MFInitial)) == CMfailed) ||
                     (snprintf (stateName[1],sizeof(stateName[1]), "tZ%02d", i) == 0) || ((_MDStateStrat_tZ  [i] = MFVarGetID (stateName[1], MFNoUnit, MFFloat, MFState, MFInitial)) == CMfailed) ||
                     (snprintf (stateName[2],sizeof(stateName[2]), "aD%02d", i) == 0) || ((_MDStateStrat_aD  [i] = MFVarGetID (stateName[2], MFNoUnit, MFFloat, MFState, MFInitial)) == CMfailed) ||
@@ -27,6 +27,15 @@ typedef enum { MDpet,
                MDparticulatenutrients,
                MDwaterdensity} MDoption;
 
+static int (*_MDModelDef) () = MDCore_WaterBalanceDef;
+
+// Defines the selected model followed by the aggregated outputs and the checkpoint of module held state
+static int _MDModel () {
+    int ret = _MDModelDef ();
+
+    return ((ret == CMfailed) || (MDAggregateDef () == CMfailed) || (MDCheckpointInit () == CMfailed) ? CMfailed : ret);
+}
+
 int main (int argc,char *argv []) {
     int argNum;
     int optID = MDbalance;
@@ -51,21 +60,21 @@ int main (int argc,char *argv []) {
     if ((optStr = MFOptionGet(optName)) != (char *) NULL) optID = CMoptLookup(options, optStr, true);
 
     switch (optID) {
-        case MDpet:                       return (MFModelRun(argc, argv, argNum, MDCore_RainPotETDef));
-        case MDsurplus:                   return (MFModelRun(argc, argv, argNum, MDCore_RainWaterSurplusDef));
-        case MDinfiltration:              return (MFModelRun(argc, argv, argNum, MDCore_RainInfiltrationDef));
-        case MDrunoff:                    return (MFModelRun(argc, argv, argNum, MDCore_RunoffDef));
-        case MDdischarge:                 return (MFModelRun(argc, argv, argNum, MDRouting_DischargeDef));
-        case MDbalance:                   return (MFModelRun(argc, argv, argNum, MDCore_WaterBalanceDef));
-        case MDwatertemp:                 return (MFModelRun(argc, argv, argNum, MDWTemp_RiverDef));
-        case MDthermal:                   return (MFModelRun(argc, argv, argNum, MDWTemp_ThermalInputsDef));
-        case MDbankfullQcalc:             return (MFModelRun(argc, argv, argNum, MDRouting_BankfullQcalcDef));
-        case MDsedimentflux:              return (MFModelRun(argc, argv, argNum, MDSediment_FluxDef));
-        case MDbedloadflux:               return (MFModelRun(argc, argv, argNum, MDSediment_BedloadFluxDef));
-        case MDBQARTpreprocess:           return (MFModelRun(argc, argv, argNum, MDSediment_BQARTpreprocessDef));
-        case MDparticulatenutrients:      return (MFModelRun(argc,argv,argNum,   MDSediment_ParticulateNutrientsDef));
-        case MDwaterdensity:              return (MFModelRun(argc,argv,argNum,   MDSediment_WaterDensityDef));
+        case MDpet:                       _MDModelDef = MDCore_RainPotETDef; break;
+        case MDsurplus:                   _MDModelDef = MDCore_RainWaterSurplusDef; break;
+        case MDinfiltration:              _MDModelDef = MDCore_RainInfiltrationDef; break;
+        case MDrunoff:                    _MDModelDef = MDCore_RunoffDef; break;
+        case MDdischarge:                 _MDModelDef = MDRouting_DischargeDef; break;
+        case MDbalance:                   _MDModelDef = MDCore_WaterBalanceDef; break;
+        case MDwatertemp:                 _MDModelDef = MDWTemp_RiverDef; break;
+        case MDthermal:                   _MDModelDef = MDWTemp_ThermalInputsDef; break;
+        case MDbankfullQcalc:             _MDModelDef = MDRouting_BankfullQcalcDef; break;
+        case MDsedimentflux:              _MDModelDef = MDSediment_FluxDef; break;
+        case MDbedloadflux:               _MDModelDef = MDSediment_BedloadFluxDef; break;
+        case MDBQARTpreprocess:           _MDModelDef = MDSediment_BQARTpreprocessDef; break;
+        case MDparticulatenutrients:      _MDModelDef = MDSediment_ParticulateNutrientsDef; break;
+        case MDwaterdensity:              _MDModelDef = MDSediment_WaterDensityDef; break;
+        default: MFOptionMessage(optName, optStr, options); return (CMfailed);
     }
-    MFOptionMessage(optName, optStr, options);
-    return (CMfailed);
+    return (MFModelRun(argc, argv, argNum, _MDModel));
 }
@@ -4,6 +4,10 @@ module extern
    use rstrat_types
    use timestepping
    implicit none
+
+   integer(C_INT), parameter :: forcing_dtime = 24      ! Input forcing dtime is 24hrs from WBM always
+   integer(C_INT), parameter :: s_dtime = 3600*forcing_dtime/dtime_base ! Number of base sub-timesteps per forcing timestep
+
 contains
 
    subroutine stratify(ti, lme_error, in_t, in_f, ou_f, &
@@ -49,25 +53,62 @@ contains
       real(r8), intent(inout) :: v_zt(nlayer_max)   ! Total reservoir volume at depth z from surface(m3)
 
       real(r8), intent(inout) :: s_tin              ! Initial total storage (m^3)
-      integer(C_INT), parameter :: forcing_dtime = 24 ! Input forcing dtime is 24hrs from WBM always
-
-      ! Set our s_dtime such that there is 60s per subtimestep
-      s_dtime = 3600*forcing_dtime/dtime
 
       call rgeom(resgeo)
       call depth_area_vol(resgeo, dav)
       call stratify_internal(ti, lme_error, in_t, in_f, ou_f, &
                              coszen, lw_abs, s_w, rh, t_air, u_2, &
                              resgeo, d_z, t_z, &
-                             m_zn, a_d, d_v, v_zt, s_tin, m_cal, dav)
+                             m_zn, a_d, d_v, v_zt, s_tin, m_cal, dav, zero)
 
    end subroutine stratify
 
+   subroutine stratify_cached(dav, ti, lme_error, in_t, in_f, ou_f, &
+                              coszen, lw_abs, s_w, rh, t_air, u_2, &
+                              resgeo, d_z, t_z, &
+                              m_zn, a_d, d_v, v_zt, s_tin, m_cal, tol) bind(C, name="stratify_cached")
+
+      ! Same as stratify, but the depth / area / volume relationship is kept by the caller in dav
+      ! (built on the first call) and the sub-timesteps are adapted to tol (K), fixed 60s
+      ! sub-timesteps when tol <= 0. All state is passed in, so reservoirs can be processed concurrently.
+      type(res_dav), intent(inout) :: dav
+      real(r8), intent(in), value :: tol
+      integer(C_INT), intent(in), value :: ti
+      integer(C_INT), intent(inout) :: lme_error
+
+      real(r8), intent(in) :: in_t, in_f
+      real(r8), intent(inout) :: ou_f
+      real(r8), intent(in) :: coszen, lw_abs, s_w, rh, t_air, u_2
+
+      type(reservoir_geometry), intent(inout) :: resgeo
+
+      real(r8), intent(inout) :: m_cal
+      real(r8), intent(inout) :: d_z(nlayer_max), t_z(nlayer_max), m_zn(nlayer_max)
+      real(r8), intent(inout) :: a_d(nlayer_max), d_v(nlayer_max), v_zt(nlayer_max)
+      real(r8), intent(inout) :: s_tin
+
+      ! rgeom is cheap and resets n_depth / d_res on every call, so it is kept here
+      call rgeom(resgeo)
+      if (dav%built == 0) then
+         call depth_area_vol(resgeo, dav)
+      else
+         ! depth_area_vol leaves the correcting factors folded into the tables
+         resgeo%A_cf = 1._r8
+         resgeo%V_cf = 1._r8
+      end if
+      call stratify_internal(ti, lme_error, in_t, in_f, ou_f, &
+                             coszen, lw_abs, s_w, rh, t_air, u_2, &
+                             resgeo, d_z, t_z, &
+                             m_zn, a_d, d_v, v_zt, s_tin, m_cal, dav, tol)
+
+   end subroutine stratify_cached
+
    subroutine stratify_internal(ti, lme_error, in_t, in_f, ou_f, &
                                 coszen, lw_abs, s_w, rh, t_air, u_2, &
                                 resgeo, d_z, t_z, &
-                                m_zn, a_d, d_v, v_zt, s_tin, m_cal, dav)
+                                m_zn, a_d, d_v, v_zt, s_tin, m_cal, dav, tol)
 
+      use, intrinsic :: IEEE_ARITHMETIC, only: ieee_is_nan
       integer(C_INT), intent(in), value :: ti
       ! Used to indicate problem with layer mass / energy subroutine if lme_error != 0
 
@@ -100,6 +141,7 @@ contains
       real(r8), intent(inout) :: v_zt(nlayer_max)   ! Total reservoir volume at depth z from surface(m3)
 
       real(r8), intent(inout) :: s_tin              ! Initial total storage (m^3)
+      real(r8), intent(in) :: tol                   ! Largest layer temperature change per adaptive sub-timestep (K)
 
       ! ---- Local variables (keeps information between subtimesteps) ----
       real(r8) :: rho_z(nlayer_max)  ! Depth based water density  (kg/m3)
@@ -113,6 +155,17 @@ contains
       real(r8) :: d_zsb(nlayer_max)    ! Depth at z from surface averaged over sub-timestep(m)
       integer :: ww                    ! Subtimestep index
       integer :: k                     ! Layer index
+      integer :: mult                  ! Current sub-timestep length in base sub-timesteps
+      integer(C_INT) :: dtime          ! Current sub-timestep length (sec)
+      integer :: done                  ! Base sub-timesteps completed
+      integer :: n_depth_0             ! Number of layers before the sub-timestep
+      real(r8) :: dt_max               ! Largest layer temperature change over the sub-timestep (K)
+      ! Copy of the evolving state, restored when an adaptive sub-timestep is rejected
+      type(reservoir_geometry) :: resgeo_0
+      real(r8) :: t_z_0(nlayer_max), d_z_0(nlayer_max), m_zn_0(nlayer_max), a_d_0(nlayer_max), &
+                  d_v_0(nlayer_max), v_zt_0(nlayer_max), rho_z_0(nlayer_max), enr_0_0(nlayer_max), &
+                  t_zsub_0(nlayer_max), d_zsb_0(nlayer_max), cntr_0(nlayer_max), cntr1_0(nlayer_max), &
+                  cntr2_0(nlayer_max), s_tin_0, m_cal_0, ou_f_0, d_res_sub_0
       ! Initialize
       d_res_sub = zero
       ! Initialize arrays
@@ -132,8 +185,28 @@ contains
          end do
       end if
 
-      ! Start calculation for each sub-timestep
-      do ww = 1, s_dtime
+      ! Start calculation for each sub-timestep. With tol > 0 the sub-timestep is doubled
+      ! while the layer temperatures change by less than tol/4 and the flow exchange stays
+      ! small relative to storage, and halved (repeating the step) when the temperature
+      ! change exceeds tol or the layer mass / energy balance fails.
+      ww = 0
+      done = 0
+      mult = 1
+      do while (done < s_dtime)
+         mult = min(mult, s_dtime - done)
+         if (tol > zero) then
+            n_depth_0 = resgeo%n_depth
+            t_z_0 = t_z
+         end if
+         if (tol > zero .and. mult > 1) then
+            resgeo_0 = resgeo
+            d_z_0 = d_z; m_zn_0 = m_zn; a_d_0 = a_d; d_v_0 = d_v; v_zt_0 = v_zt
+            rho_z_0 = rho_z; enr_0_0 = enr_0; t_zsub_0 = t_zsub; d_zsb_0 = d_zsb
+            cntr_0 = cntr; cntr1_0 = cntr1; cntr2_0 = cntr2
+            s_tin_0 = s_tin; m_cal_0 = m_cal; ou_f_0 = ou_f; d_res_sub_0 = d_res_sub
+         end if
+         ww = ww + 1
+         dtime = dtime_base*mult
          call subtimestep(ww, ti, resgeo%n_depth, coszen, lw_abs, s_w, rh, t_air, u_2, &
                           t_z, v_zt, resgeo%d_res, &
                           in_f, rho_z, resgeo%A_cf, a_d, s_tin, resgeo%V_df, &
@@ -141,10 +214,33 @@ contains
                           resgeo%dd_z, enr_0, dav%d_zi, d_z, dav%a_di, &
                           dav%v_zti, resgeo%ddz_min, resgeo%ddz_max, m_cal, &
                           lme_error, resgeo%M_W, resgeo%M_L, d_zsb, cntr, t_zsub, &
-                          d_res_sub, cntr1, cntr2)
+                          d_res_sub, cntr1, cntr2, real(mult, r8), dtime)
+         if (tol > zero) then
+            k = min(resgeo%n_depth, n_depth_0)
+            dt_max = maxval(abs(t_z(1:k) - t_z_0(1:k)))
+         end if
+         if (tol > zero .and. mult > 1) then
+            if (lme_error == 1 .or. any(ieee_is_nan(t_z(1:k))) .or. dt_max > tol .or. &
+                resgeo%n_depth /= n_depth_0) then
+               resgeo = resgeo_0
+               t_z = t_z_0; d_z = d_z_0; m_zn = m_zn_0; a_d = a_d_0; d_v = d_v_0; v_zt = v_zt_0
+               rho_z = rho_z_0; enr_0 = enr_0_0; t_zsub = t_zsub_0; d_zsb = d_zsb_0
+               cntr = cntr_0; cntr1 = cntr1_0; cntr2 = cntr2_0
+               s_tin = s_tin_0; m_cal = m_cal_0; ou_f = ou_f_0; d_res_sub = d_res_sub_0
+               lme_error = 0
+               ww = ww - 1
+               mult = mult/2
+               cycle
+            end if
+         end if
          if (lme_error == 1) then
             return
          end if
+         done = done + mult
+         if (tol > zero) then
+            if (dt_max < 0.25_r8*tol .and. 2*mult <= adapt_max_mult .and. &
+                (in_f + ou_f)*dtime_base*2*mult <= adapt_flow_frac*v_zt(resgeo%n_depth + 1)) mult = 2*mult
+         end if
       end do
 
       ! This used to happen in finalise_timestep before reversing the
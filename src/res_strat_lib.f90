@@ -5,8 +5,9 @@ module constants
    ! integer(C_INT), parameter :: r8 = C_LONG_DOUBLE
    integer(C_INT), parameter :: nlayer_max = 30         ! Maximum number of layers
    integer(C_INT), parameter :: yr_max = 10             ! Maximum number of years simulated
-   integer(C_INT), parameter :: dtime = 60              ! time step (sec)
-   integer(C_INT) :: s_dtime = 3600/dtime               ! number of sub hourly time step
+   integer(C_INT), parameter :: dtime_base = 60         ! base sub time step (sec), the current one is passed as dtime
+   integer(C_INT), parameter :: adapt_max_mult = 64     ! Largest adaptive sub time step in multiples of dtime_base
+   real(r8), parameter :: adapt_flow_frac = 0.01_r8     ! Largest storage fraction exchanged by inflow + outflow in one adaptive step
    integer(C_INT), parameter :: d_nn = 250              ! Number of vertical depth descretization to establish depth-area-volume relationship
 
    logical:: DEBUG = .false.                            ! Print debugging statements
@@ -58,10 +59,11 @@ module rstrat_types
 
    end type
 
-   type :: res_dav
-      real(r8), allocatable :: d_zi(:)    ! Initial depth for reservoir geometry
-      real(r8), allocatable :: a_di(:)    ! Initial area for reservoir geometry
-      real(r8), allocatable :: v_zti(:)   ! Initial volume for reservoir geometry
+   type, bind(C) :: res_dav
+      real(r8) :: d_zi(d_nn + 1)    ! Initial depth for reservoir geometry
+      real(r8) :: a_di(d_nn + 1)    ! Initial area for reservoir geometry
+      real(r8) :: v_zti(d_nn + 1)   ! Initial volume for reservoir geometry
+      integer(C_INT) :: built       ! Set once depth_area_vol has filled the tables
    end type
 
 end module
@@ -162,18 +164,6 @@ contains
       ! if the depth-area-vol computation is re-done each time.
       d_res = 0.95*resgeo%d_ht
 
-      if (allocated(dav%v_zti)) then
-         deallocate (dav%v_zti)
-      end if
-      if (allocated(dav%a_di)) then
-         deallocate (dav%a_di)
-      end if
-      if (allocated(dav%d_zi)) then
-         deallocate (dav%d_zi)
-      end if
-      allocate (dav%v_zti(d_nn + 1))
-      allocate (dav%a_di(d_nn + 1))
-      allocate (dav%d_zi(d_nn + 1))
       dav%v_zti = zero
       dav%a_di = zero
       dav%d_zi = zero
@@ -233,6 +223,7 @@ contains
       dav%v_zti = resgeo%V_cf*dav%v_zti    ! Volume corrected for error
       resgeo%A_cf = 1._r8
       resgeo%V_cf = 1._r8
+      dav%built = 1
 
    end subroutine depth_area_vol
 
@@ -294,8 +285,9 @@ contains
       end if
    end subroutine layer_thickness
 
-   subroutine setup_solve(a, b, c, r, A_cf, V_cf, phi_o, sh_net, a_d, df_eff, t_z, phi_z, rho_z, d_v, dd_z)
+   subroutine setup_solve(a, b, c, r, A_cf, V_cf, phi_o, sh_net, a_d, df_eff, t_z, phi_z, rho_z, d_v, dd_z, dtime)
       implicit none
+      integer(C_INT), intent(in) :: dtime ! sub time step (sec)
       real(r8), intent(inout) :: a(:), b(:), c(:), r(:)
       real(r8), intent(in) :: A_cf, &
                               V_cf, &
@@ -442,8 +434,9 @@ contains
 
    subroutine diffusion_coeff(n_depth, u_2, A_cf, V_cf, M_W, M_L, &
                               rho_z, a_d, v_zt, dv_in, dv_ou, dd_z, &
-                              drhodz, df_eff, d_z)
+                              drhodz, df_eff, d_z, dtime)
       implicit none
+      integer(C_INT), intent(in) :: dtime ! sub time step (sec)
 
       integer, intent(in) :: n_depth
       real(r8), intent(in) :: u_2, A_cf, V_cf, M_W, M_L
@@ -520,7 +513,7 @@ contains
       Fr(2:n_depth) = (grav*dd_z(2:n_depth)*drhodz(2:n_depth)/rho_w)/l_vel(2:n_depth)**2.
 
       ! Calculate diffusion coefficients
-      df_eff(2:n_depth) = min(max(dtime**2.*((cfw*dis_w/(1 + ri(2:n_depth))) &
+      df_eff(2:n_depth) = min(max(dtime_base**2.*((cfw*dis_w/(1 + ri(2:n_depth))) &
                                              + (0.5*cfa*(dis_ad(2:n_depth) + dis_ad(1:n_depth - 1)) &
                                                 /(1 + Fr(2:n_depth)))), k_m), 5.56e-03_r8)
 
@@ -538,8 +531,9 @@ contains
                                 d_v, m_zn, dd_z, t_z, enr_0, d_zi, rho_z, &
                                 d_z, a_d, a_di, v_zti, v_zt, s_t, s_tin, V_df, A_cf, &
                                 sh_net, eta, ddz_min, ddz_max, phi_z, in_t, enr_1, &
-                                d_res, ww, ti, num_fac, m_cal, lme_error)
+                                d_res, ww, ti, num_fac, m_cal, lme_error, dtime)
       implicit none
+      integer(C_INT), intent(in) :: dtime ! sub time step (sec)
 
       integer(C_INT), intent(inout) :: n_depth
       integer :: i, j, m, k, l, ii
@@ -1002,8 +996,9 @@ contains
       deallocate (phi_x)
    end subroutine
 
-   subroutine convective_mix(n_depth, rho_z, t_z, d_v, m_zn, enr_1, V_cf, num_fac)
+   subroutine convective_mix(n_depth, rho_z, t_z, d_v, m_zn, enr_1, V_cf, num_fac, dtime)
       implicit none
+      integer(C_INT), intent(in) :: dtime ! sub time step (sec)
 
       integer, intent(in) :: n_depth
       real(r8), intent(inout) :: rho_z(nlayer_max), &
@@ -1126,8 +1121,9 @@ contains
 
    end subroutine convective_mix
 
-   subroutine convective_mix_nogoto(n_depth, rho_z, t_z, d_v, m_zn, enr_1, V_cf, num_fac)
+   subroutine convective_mix_nogoto(n_depth, rho_z, t_z, d_v, m_zn, enr_1, V_cf, num_fac, dtime)
       implicit none
+      integer(C_INT), intent(in) :: dtime ! sub time step (sec)
 
       integer, intent(in) :: n_depth
       real(r8), intent(inout) :: rho_z(nlayer_max), &
@@ -1313,11 +1309,12 @@ contains
 
    end subroutine flow_contrib
 
-   subroutine flowdist(n_depth, in_f, in_t, ou_f, d_v, v_zt, dv_in, dv_ou, dm_in)
+   subroutine flowdist(n_depth, in_f, in_t, ou_f, d_v, v_zt, dv_in, dv_ou, dm_in, dtime)
 !*******************************************************************************************************
 !         Calculation inflow/outflow contribution adopted from CE-QUAL-R1 model
 !*******************************************************************************************************
       implicit none
+      integer(C_INT), intent(in) :: dtime ! sub time step (sec)
       integer, intent(in)  :: n_depth
       real(r8), intent(in)  :: in_f, in_t, ou_f, d_v(nlayer_max), v_zt(nlayer_max)
       real(r8), dimension(nlayer_max), intent(out) :: dv_in, dv_ou, dm_in   ! layer inflow/outflow (m3/s)
@@ -1374,7 +1371,7 @@ contains
 
    subroutine finalise_subtimestep(n_depth, &
                                    t_z_old, t_z, cntr, cntr1, cntr2, phi_z, &
-                                   dd_z, d_zsb, t_zsub, d_res_sub, d_res)
+                                   dd_z, d_zsb, t_zsub, d_res_sub, d_res, wt)
 
       implicit none
       ! Calculate count for sub-timestep averaging
@@ -1391,20 +1388,21 @@ contains
                                  d_res_sub
 
       real(r8), intent(inout) :: d_res
+      real(r8), intent(in) :: wt      ! Sub-timestep length in base sub-timesteps (averaging weight)
       real(r8) ::d_zs(nlayer_max)   ! Depth at z from surface (m)
       integer :: j
       do j = 1, nlayer_max
          if (abs(t_z_old(j)) > 1e-20_r8 .and. abs(t_z(j)) > 1e-20_r8) then
-            cntr1(j) = cntr1(j) + 1.0_r8
+            cntr1(j) = cntr1(j) + wt
             cntr2(j) = zero
          else
             cntr1(j) = zero
-            cntr2(j) = cntr2(j) + 1.0_r8
+            cntr2(j) = cntr2(j) + wt
          end if
          cntr(j) = cntr1(j) + cntr2(j)
       end do
 
-      d_res_sub = d_res_sub + d_res
+      d_res_sub = d_res_sub + d_res*wt
       phi_z(n_depth + 1:) = zero
       ! Calculate layer depth for profile plot(minimum at the top)
       if (n_depth >= 2) then
@@ -1423,8 +1421,8 @@ contains
 
       ! Sum sub-timestep variables
       do j = 1, nlayer_max
-         t_zsub(j) = t_zsub(j) + t_z(j)
-         d_zsb(j) = d_zsb(j) + d_zs(j)
+         t_zsub(j) = t_zsub(j) + t_z(j)*wt
+         d_zsb(j) = d_zsb(j) + d_zs(j)*wt
       end do
 
    end subroutine finalise_subtimestep
@@ -1497,7 +1495,7 @@ contains
                           rho_z, A_cf, a_d, s_tin, V_df, d_ht, ou_f, in_t, d_v, &
                           V_cf, m_zn, dd_z, enr_0, d_zi, d_z, a_di, v_zti, &
                           ddz_min, ddz_max, m_cal, lme_error, M_W, M_L, &
-                          d_zsb, cntr, t_zsub, d_res_sub, cntr1, cntr2)
+                          d_zsb, cntr, t_zsub, d_res_sub, cntr1, cntr2, wt, dtime)
 
       use, intrinsic :: IEEE_ARITHMETIC, only: ieee_is_nan
       integer, intent(inout) :: n_depth
@@ -1541,9 +1539,11 @@ contains
                               M_W, &
                               M_L, &
                               in_t, &
-                              in_f
+                              in_f, &
+                              wt        ! Sub-timestep length in base sub-timesteps
 
       integer, intent(in) :: ww, ti
+      integer(C_INT), intent(in) :: dtime ! sub time step (sec)
       real(r8), dimension(:), allocatable :: t_z_old, &
                                              dv_ou, &   ! volume decrease at layer due to inflow(m3)
                                              dv_in, &      ! volume increment at layer due to inflow(m^3)
@@ -1601,7 +1601,7 @@ contains
       allocate (dv_ou(nlayer_max))
       allocate (dv_in(nlayer_max))
       allocate (dm_in(nlayer_max))
-      call flowdist(n_depth, in_f, in_t, ou_f, d_v, v_zt, dv_in, dv_ou, dm_in)
+      call flowdist(n_depth, in_f, in_t, ou_f, d_v, v_zt, dv_in, dv_ou, dm_in, dtime)
 
       ! Resize layer thickness and numbers based on inflow/outflow contribution
       ! Calculate initial layer and total mass (kg)
@@ -1611,7 +1611,7 @@ contains
                              d_v, m_zn, dd_z, t_z, enr_0, d_zi, rho_z, &
                              d_z, a_d, a_di, v_zti, v_zt, s_t, s_tin, V_df, A_cf, &
                              sh_net, eta, ddz_min, ddz_max, phi_z, in_t, enr_1, &
-                             d_res, ww, ti, num_fac, m_cal, lme_error)
+                             d_res, ww, ti, num_fac, m_cal, lme_error, dtime)
       deallocate (dm_in)
       if (lme_error == 1) then
          return
@@ -1620,7 +1620,7 @@ contains
       ! Calculation of effective diffusion coefficient
       call diffusion_coeff(n_depth, u_2, A_cf, V_cf, M_W, M_L, &
                            rho_z, a_d, v_zt, dv_in, dv_ou, dd_z, &
-                           drhodz, df_eff, d_z)
+                           drhodz, df_eff, d_z, dtime)
       deallocate (dv_ou)
       deallocate (dv_in)
 
@@ -1632,7 +1632,7 @@ contains
       call setup_solve(a(:n_depth), b(:n_depth), c(:n_depth), r(:n_depth), &
                        A_cf, V_cf, phi_o, sh_net, &
                        a_d(:n_depth + 1), df_eff(:n_depth + 1), t_z(:n_depth), &
-                       phi_z(:n_depth), rho_z(:n_depth), d_v(:n_depth), dd_z(:n_depth + 1))
+                       phi_z(:n_depth), rho_z(:n_depth), d_v(:n_depth), dd_z(:n_depth + 1), dtime)
       ! Solve for temperature
       call solve(a(:n_depth), b(:n_depth), c(:n_depth), r(:n_depth), t_z(:n_depth))
       deallocate (a)
@@ -1647,14 +1647,14 @@ contains
             return
          end if
       end do
-      call convective_mix_nogoto(n_depth, rho_z, t_z, d_v, m_zn, enr_1, V_cf, num_fac)
-      ! call convective_mix(n_depth, rho_z, t_z, d_v, m_zn, enr_1, V_cf, num_fac)
+      call convective_mix_nogoto(n_depth, rho_z, t_z, d_v, m_zn, enr_1, V_cf, num_fac, dtime)
+      ! call convective_mix(n_depth, rho_z, t_z, d_v, m_zn, enr_1, V_cf, num_fac, dtime)
 
       deallocate (enr_1)
 
       call finalise_subtimestep(n_depth, &
                                 t_z_old, t_z, cntr, cntr1, cntr2, phi_z, &
-                                dd_z, d_zsb, t_zsub, d_res_sub, d_res)
+                                dd_z, d_zsb, t_zsub, d_res_sub, d_res, wt)
       deallocate (phi_z)
       deallocate (t_z_old)
 